@@ -0,0 +1,102 @@
+#pragma once
+#include "aznyan_types.h"
+#include <array>
+#include <limits>
+
+namespace aznyan {
+
+/**
+ * Linear value of every 8-bit sRGB level, as given by srgb_to_linear().
+ */
+inline const std::array<float, 256>& srgb_lut() {
+  static const std::array<float, 256> lut = [] {
+    std::array<float, 256> t;
+    for (int v = 0; v < 256; ++v) {
+      t[v] = srgb_to_linear(static_cast<float>(v / 255.0));
+    }
+    return t;
+  }();
+  return lut;
+}
+
+/**
+ * (v / 255)^gamma for every 8-bit level v.
+ */
+inline std::array<float, 256> power_lut(double gamma) {
+  std::array<float, 256> t;
+  for (int v = 0; v < 256; ++v) {
+    t[v] = static_cast<float>(std::pow(v / 255.0, gamma));
+  }
+  return t;
+}
+
+/**
+ * Encodes values to 8-bit through a monotone transfer function without
+ * evaluating it per sample. The boundaries between output levels are
+ * found once with `decode`, the inverse of the transfer function, and
+ * each sample is then placed among them by a branchless binary search.
+ *
+ * With `bias` 0.5 this rounds to the nearest level, like
+ * `saturate_cast<uchar>(encode(v) * 255)`; with 0 it truncates.
+ */
+class ByteEncoder {
+ public:
+  template <typename Decode>
+  ByteEncoder(Decode decode, float bias) {
+    bounds_[0] = -std::numeric_limits<float>::infinity();
+    for (int k = 1; k < 256; ++k) {
+      bounds_[k] = static_cast<float>(decode((k - bias) / 255.f));
+    }
+  }
+
+  uchar operator()(float v) const {
+    int k = 0;
+    for (int step = 128; step > 0; step >>= 1) {
+      k += (bounds_[k + step] <= v) ? step : 0;
+    }
+    return static_cast<uchar>(k);
+  }
+
+ private:
+  std::array<float, 256> bounds_;
+};
+
+// Rounds linear values to their nearest 8-bit sRGB level.
+inline const ByteEncoder& srgb_encoder() {
+  static const ByteEncoder enc(srgb_to_linear, .5f);
+  return enc;
+}
+
+/**
+ * Converts an 8-bit BGR image to linear light in CV_32FC3.
+ */
+inline cv::Mat decode_linear(const cv::Mat& bgr) {
+  const std::array<float, 256>& lut = srgb_lut();
+  cv::Mat lin(bgr.size(), CV_32FC3);
+  aznyan::parallel_for(0, bgr.rows, [&](int y) {
+    const cv::Vec3b* src = bgr.ptr<cv::Vec3b>(y);
+    cv::Vec3f* dst = lin.ptr<cv::Vec3f>(y);
+    for (int x = 0; x < bgr.cols; x++) {
+      dst[x] = cv::Vec3f(lut[src[x][0]], lut[src[x][1]], lut[src[x][2]]);
+    }
+  });
+  return lin;
+}
+
+/**
+ * Converts a linear-light CV_32FC3 image back to 8-bit sRGB.
+ */
+inline cv::Mat encode_linear(const cv::Mat& lin) {
+  const ByteEncoder& enc = srgb_encoder();
+  cv::Mat bgr(lin.size(), CV_8UC3);
+  aznyan::parallel_for(0, lin.rows, [&](int y) {
+    const cv::Vec3f* src = lin.ptr<cv::Vec3f>(y);
+    cv::Vec3b* dst = bgr.ptr<cv::Vec3b>(y);
+    for (int x = 0; x < lin.cols; x++) {
+      dst[x] = cv::Vec3b(enc(src[x][0]), enc(src[x][1]), enc(src[x][2]));
+    }
+  });
+  return bgr;
+}
+
+}  // namespace aznyan
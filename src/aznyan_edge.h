@@ -0,0 +1,60 @@
+#pragma once
+#include "aznyan_types.h"
+
+namespace aznyan {
+
+/**
+ * Rows per band of the tiled edge passes.
+ */
+static constexpr int edge_band_rows = 64;
+
+/**
+ * Calls `func(y0, y1)` for bands of rows in parallel.
+ *
+ * Derivatives taken on a band (a ROI of the whole image) read the real
+ * neighbors across band boundaries, so the result does not depend on the
+ * tiling. BORDER_ISOLATED forbids that, so such images are not tiled.
+ */
+template <typename FUNC>
+inline void edge_bands(int rows, int border, FUNC func) {
+  const int band = (border & cv::BORDER_ISOLATED) ? rows : edge_band_rows;
+  const int bands = (rows + band - 1) / band;
+  parallel_for(0, bands, [&](int b) {
+    const int y0 = b * band;
+    func(y0, std::min(rows, y0 + band));
+  });
+}
+
+/**
+ * Computes a derivative of each channel of an 8-bit image and sums them.
+ *
+ * `deriv(src, dst)` must write a CV_32F derivative of intensities scaled to
+ * [0, 1] into `dst`. Writes `|255 * sum|` to `out` and, if `balp`, the
+ * binarized edge map to `alpha`, in the same pass over each band.
+ */
+template <typename DERIV>
+inline void edge_response(const cv::Mat& src, cv::Mat& out, cv::Mat& alpha,
+                          bool balp, int border, DERIV deriv) {
+  const int cn = src.channels();
+  out.create(src.size(), CV_8UC1);
+  if (balp) alpha.create(src.size(), CV_8UC1);
+  edge_bands(src.rows, border, [&](int y0, int y1) {
+    cv::Mat grad;
+    deriv(src.rowRange(y0, y1), grad);
+    for (int y = y0; y < y1; y++) {
+      const float* g = grad.ptr<float>(y - y0);
+      uchar* o = out.ptr<uchar>(y);
+      for (int x = 0; x < src.cols; x++) {
+        float sum = 0.0f;
+        for (int c = 0; c < cn; c++) sum += g[x * cn + c];
+        o[x] = cv::saturate_cast<uchar>(std::abs(sum * 255.0f));
+      }
+      if (balp) {
+        uchar* a = alpha.ptr<uchar>(y);
+        for (int x = 0; x < src.cols; x++) a[x] = o[x] > 0 ? 255 : 0;
+      }
+    }
+  });
+}
+
+}  // namespace aznyan
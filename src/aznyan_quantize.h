@@ -0,0 +1,152 @@
+#pragma once
+#include "aznyan_types.h"
+#include <array>
+#include <limits>
+
+namespace aznyan {
+
+// Bits kept per channel by the color histogram shared by the quantizers.
+constexpr int quant_bits = 5;
+constexpr int quant_side = 1 << quant_bits;
+constexpr int quant_cells = quant_side * quant_side * quant_side;
+
+/**
+ * One histogram cell. Sums are of the original 8-bit values, so averages
+ * taken over cells are exact averages of the pixels.
+ */
+struct ColorCell {
+  long long count;
+  long long sum_b;
+  long long sum_g;
+  long long sum_r;
+  long long sum_sq;
+};
+
+inline int color_cell(int b, int g, int r) {
+  return (r << (2 * quant_bits)) | (g << quant_bits) | b;
+}
+
+inline int color_cell(const cv::Vec3b& px) {
+  constexpr int shift = 8 - quant_bits;
+  return color_cell(px[0] >> shift, px[1] >> shift, px[2] >> shift);
+}
+
+/**
+ * Palette together with the palette index of every histogram cell.
+ * Cells that hold no pixels may point anywhere.
+ */
+struct CellPalette {
+  std::vector<cv::Vec3b> colors;
+  std::vector<int> index;
+};
+
+/**
+ * Palette laid out as one float array per channel, for the linear
+ * nearest-color search of the k-means passes.
+ *
+ * The arrays are padded to whole blocks of `lanes` entries with copies of
+ * the first color, and nearest() keeps a running minimum per lane with
+ * masks rather than branches, so the block loop vectorizes at -O2. Ties
+ * resolve to the lowest index, so padding never wins.
+ */
+struct PaletteSoA {
+  static constexpr int lanes = 8;
+  std::vector<float> b;
+  std::vector<float> g;
+  std::vector<float> r;
+
+  explicit PaletteSoA(const std::vector<cv::Vec3b>& colors) {
+    const std::size_t n = colors.size();
+    const std::size_t padded = (n + lanes - 1) / lanes * lanes;
+    for (std::size_t i = 0; i < padded; ++i) {
+      const cv::Vec3b& c = colors[i < n ? i : 0];
+      b.push_back(c[0]);
+      g.push_back(c[1]);
+      r.push_back(c[2]);
+    }
+  }
+
+  int nearest(float vb, float vg, float vr) const {
+    const int n = static_cast<int>(b.size());
+    const float* pb = b.data();
+    const float* pg = g.data();
+    const float* pr = r.data();
+    std::array<float, lanes> lane_d;
+    std::array<int, lanes> lane_i;
+    lane_d.fill(std::numeric_limits<float>::max());
+    lane_i.fill(0);
+    for (int i = 0; i < n; i += lanes) {
+      for (int k = 0; k < lanes; ++k) {
+        const float db = pb[i + k] - vb, dg = pg[i + k] - vg,
+                    dr = pr[i + k] - vr;
+        const float d = db * db + dg * dg + dr * dr;
+        const int closer = -static_cast<int>(d < lane_d[k]);
+        lane_i[k] = (lane_i[k] & ~closer) | ((i + k) & closer);
+        lane_d[k] = std::min(lane_d[k], d);
+      }
+    }
+    int best = lane_i[0];
+    float best_d = lane_d[0];
+    for (int k = 1; k < lanes; ++k) {
+      if (lane_d[k] < best_d || (lane_d[k] == best_d && lane_i[k] < best)) {
+        best_d = lane_d[k];
+        best = lane_i[k];
+      }
+    }
+    return best;
+  }
+};
+
+/**
+ * Exact nearest-color lookup for a fixed palette.
+ *
+ * Every histogram cell keeps the palette entries that can be the nearest
+ * one for some color inside the cell: those whose distance to the cell is
+ * at most the smallest farthest-distance of any entry. Most cells end up
+ * with a single candidate, so the lookup is usually one table read, and
+ * otherwise a search over a few entries. Ties resolve to the lowest index,
+ * as in PaletteSoA::nearest().
+ */
+class InverseColormap {
+ public:
+  explicit InverseColormap(const std::vector<cv::Vec3b>& palette);
+
+  int operator()(int b, int g, int r) const {
+    constexpr int shift = 8 - quant_bits;
+    const int cell = color_cell(b >> shift, g >> shift, r >> shift);
+    const int from = offsets_[cell], to = offsets_[cell + 1];
+    int best = candidates_[from];
+    if (to - from == 1) return best;
+    int best_d = std::numeric_limits<int>::max();
+    for (int i = from; i < to; ++i) {
+      const cv::Vec3b& c = palette_[candidates_[i]];
+      const int db = c[0] - b, dg = c[1] - g, dr = c[2] - r;
+      const int d = db * db + dg * dg + dr * dr;
+      if (d < best_d) {
+        best_d = d;
+        best = candidates_[i];
+      }
+    }
+    return best;
+  }
+
+  int operator()(const cv::Vec3b& px) const {
+    return (*this)(px[0], px[1], px[2]);
+  }
+
+ private:
+  std::vector<cv::Vec3b> palette_;
+  std::vector<int> offsets_;
+  std::vector<int> candidates_;
+};
+
+std::vector<ColorCell> color_histogram(const cv::Mat& bgr);
+
+CellPalette median_cut_palette(const std::vector<ColorCell>& hist,
+                               int n_colors);
+CellPalette wu_palette(const std::vector<ColorCell>& hist, int n_colors);
+CellPalette octree_palette(const std::vector<ColorCell>& hist, int n_colors);
+void kmeans_refine(const std::vector<ColorCell>& hist, CellPalette& palette,
+                   int iterations);
+
+}  // namespace aznyan
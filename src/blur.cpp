@@ -1,4 +1,6 @@
 #include "aznyan_types.h"
+#include <deque>
+#include <mutex>
 
 [[cpp11::register]]
 cpp11::integers azny_medianblur(const cpp11::integers& nr, int height,
@@ -35,6 +37,141 @@ cpp11::integers azny_gaussianblur(const cpp11::integers& nr, int height,
   return aznyan::encode_nr(out, bgra[1]);
 }
 
+namespace {
+
+// Cells of zero padding kept around the bilateral grid so that the blur
+// kernel never has to look outside of it.
+constexpr int kGridApron = 2;
+// Upper bound on the number of floats a bilateral grid may allocate.
+constexpr std::size_t kGridBudget = std::size_t{1} << 25;
+
+/**
+ * Approximates a bilateral filter with a bilateral grid
+ * (Chen, Paris and Durand 2007).
+ *
+ * Pixels are splatted into a (y, x, intensity) grid downsampled by
+ * `sigma_s` in space and `sigma_r` in range, the grid is blurred with a
+ * separable [1 4 6 4 1] kernel, and the result is sliced back out with
+ * trilinear interpolation. The cost depends on the size of the grid, not on
+ * the spatial sigma. Returns an empty matrix when the grid would exceed
+ * `kGridBudget`, so that callers can fall back to the exact filter.
+ */
+cv::Mat bilateral_grid(const cv::Mat& src, const cv::Mat& guide,
+                       double sigma_s, double sigma_r) {
+  const int rows = src.rows;
+  const int cols = src.cols;
+  const int cn = src.channels();
+  const float ss = static_cast<float>(sigma_s);
+  const float sr = static_cast<float>(sigma_r);
+
+  const int gh =
+      static_cast<int>(std::lround((rows - 1) / ss)) + 1 + 2 * kGridApron;
+  const int gw =
+      static_cast<int>(std::lround((cols - 1) / ss)) + 1 + 2 * kGridApron;
+  const int gd =
+      static_cast<int>(std::lround(255.0f / sr)) + 1 + 2 * kGridApron;
+  const std::size_t sz = static_cast<std::size_t>(cn + 1);
+  const std::size_t sx = sz * gd;
+  const std::size_t sy = sx * gw;
+  if (static_cast<double>(sy) * gh > static_cast<double>(kGridBudget)) {
+    return cv::Mat();
+  }
+  std::vector<float> grid(sy * gh, 0.0f);
+  std::vector<float> work(sy * gh, 0.0f);
+
+  std::vector<int> row_cell(rows), col_cell(cols);
+  for (int y = 0; y < rows; y++) {
+    row_cell[y] = static_cast<int>(std::lround(y / ss)) + kGridApron;
+  }
+  for (int x = 0; x < cols; x++) {
+    col_cell[x] = static_cast<int>(std::lround(x / ss)) + kGridApron;
+  }
+
+  // Splat. Each grid row only receives pixels from its own band of image
+  // rows, so grid rows can be filled in parallel without synchronization.
+  aznyan::parallel_for(0, gh, [&](int gy) {
+    auto lo = std::lower_bound(row_cell.begin(), row_cell.end(), gy);
+    auto hi = std::upper_bound(lo, row_cell.end(), gy);
+    for (auto it = lo; it != hi; ++it) {
+      const int y = static_cast<int>(it - row_cell.begin());
+      const uchar* s = src.ptr<uchar>(y);
+      const uchar* g = guide.ptr<uchar>(y);
+      for (int x = 0; x < cols; x++) {
+        const int gz = static_cast<int>(std::lround(g[x] / sr)) + kGridApron;
+        float* cell = &grid[gy * sy + col_cell[x] * sx + gz * sz];
+        for (int c = 0; c < cn; c++) cell[c] += s[x * cn + c];
+        cell[cn] += 1.0f;
+      }
+    }
+  });
+
+  // Blur along each axis in turn, ping-ponging between the two buffers.
+  const std::array<float, 5> taps{1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16,
+                                  1.0f / 16};
+  auto blur_axis = [&](const std::vector<float>& in, std::vector<float>& out,
+                       int axis) {
+    const std::size_t step = axis == 0 ? sy : (axis == 1 ? sx : sz);
+    const int extent = axis == 0 ? gh : (axis == 1 ? gw : gd);
+    aznyan::parallel_for(0, gh, [&](int gy) {
+      for (int gx = 0; gx < gw; gx++) {
+        for (int gz = 0; gz < gd; gz++) {
+          const int pos = axis == 0 ? gy : (axis == 1 ? gx : gz);
+          const std::size_t at = gy * sy + gx * sx + gz * sz;
+          float* dst = &out[at];
+          for (std::size_t c = 0; c < sz; c++) dst[c] = 0.0f;
+          for (int k = -2; k <= 2; k++) {
+            if (pos + k < 0 || pos + k >= extent) continue;
+            const float* cell = &in[at + k * static_cast<std::ptrdiff_t>(step)];
+            for (std::size_t c = 0; c < sz; c++) {
+              dst[c] += taps[k + 2] * cell[c];
+            }
+          }
+        }
+      }
+    });
+  };
+  blur_axis(grid, work, 0);
+  blur_axis(work, grid, 1);
+  blur_axis(grid, work, 2);
+
+  // Slice.
+  cv::Mat out(rows, cols, src.type());
+  aznyan::parallel_for(0, rows, [&](int y) {
+    const float fy = y / ss + kGridApron;
+    const int y0 = std::min(static_cast<int>(fy), gh - 2);
+    const float wy = fy - y0;
+    const uchar* s = src.ptr<uchar>(y);
+    const uchar* g = guide.ptr<uchar>(y);
+    uchar* d = out.ptr<uchar>(y);
+    std::vector<float> acc(sz);
+    for (int x = 0; x < cols; x++) {
+      const float fx = x / ss + kGridApron;
+      const float fz = g[x] / sr + kGridApron;
+      const int x0 = std::min(static_cast<int>(fx), gw - 2);
+      const int z0 = std::min(static_cast<int>(fz), gd - 2);
+      const float wx = fx - x0;
+      const float wz = fz - z0;
+      std::fill(acc.begin(), acc.end(), 0.0f);
+      for (int corner = 0; corner < 8; corner++) {
+        const int dy = corner >> 2, dx = (corner >> 1) & 1, dz = corner & 1;
+        const float w = (dy ? wy : 1.0f - wy) * (dx ? wx : 1.0f - wx) *
+                        (dz ? wz : 1.0f - wz);
+        const float* cell =
+            &work[(y0 + dy) * sy + (x0 + dx) * sx + (z0 + dz) * sz];
+        for (std::size_t c = 0; c < sz; c++) acc[c] += w * cell[c];
+      }
+      for (int c = 0; c < cn; c++) {
+        d[x * cn + c] = acc[cn] > 1e-6f
+                            ? cv::saturate_cast<uchar>(acc[c] / acc[cn])
+                            : s[x * cn + c];
+      }
+    }
+  });
+  return out;
+}
+
+}  // namespace
+
 [[cpp11::register]]
 cpp11::integers azny_bilateral(const cpp11::integers& nr, int height, int width,
                                int d, double sigmacolor, double sigmaspace,
@@ -53,6 +190,208 @@ cpp11::integers azny_bilateral(const cpp11::integers& nr, int height, int width,
   return aznyan::encode_nr(out1, out2);
 }
 
+[[cpp11::register]]
+cpp11::integers azny_bilateralgrid(const cpp11::integers& nr, int height,
+                                   int width, int d, double sigmacolor,
+                                   double sigmaspace, int border,
+                                   bool alphasync) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+
+  // The grid is padded by three spatial sigmas, which covers the support of
+  // the blurred grid, so that `border` behaves as it does for the exact
+  // filter. Falls back to cv::bilateralFilter when the sigmas are too small
+  // for a grid to pay off.
+  auto filter = [&](const cv::Mat& src, const cv::Mat& guide) {
+    cv::Mat out;
+    if (sigmaspace >= 1.0 && sigmacolor >= 1.0) {
+      const int pad = static_cast<int>(std::ceil(3.0 * sigmaspace));
+      cv::Mat src_p, guide_p;
+      cv::copyMakeBorder(src, src_p, pad, pad, pad, pad,
+                         aznyan::mode_b[border]);
+      cv::copyMakeBorder(guide, guide_p, pad, pad, pad, pad,
+                         aznyan::mode_b[border]);
+      out = bilateral_grid(src_p, guide_p, sigmaspace, sigmacolor);
+      if (!out.empty()) {
+        return cv::Mat(out(cv::Rect(pad, pad, width, height)).clone());
+      }
+    }
+    cv::bilateralFilter(src, out, d, sigmacolor, sigmaspace,
+                        aznyan::mode_b[border]);
+    return out;
+  };
+
+  cv::Mat gray;
+  cv::cvtColor(bgra[0], gray, cv::COLOR_BGR2GRAY);
+  cv::Mat out1 = filter(bgra[0], gray);
+  cv::Mat out2 = alphasync ? filter(bgra[1], bgra[1]) : bgra[1];
+  return aznyan::encode_nr(out1, out2);
+}
+
+namespace {
+
+// Kernels with at most this many taps are left to cv::filter2D.
+constexpr int kDirectMaxArea = 15 * 15;
+// Number of kernel spectra kept for reuse across calls.
+constexpr std::size_t kSpectrumCacheSize = 16;
+
+/**
+ * How a convolution kernel is applied.
+ *
+ * `terms` holds (kernelX, kernelY) pairs for the separable path;
+ * the kernel is the sum of their outer products, taken from its SVD.
+ */
+struct ConvPlan {
+  enum class Path { direct, separable, dft };
+  Path path;
+  cv::Mat kernel;
+  std::vector<std::pair<cv::Mat, cv::Mat>> terms;
+};
+
+ConvPlan plan_convolution(const cv::Mat& kernel) {
+  ConvPlan plan{ConvPlan::Path::direct, kernel, {}};
+  if (kernel.rows > 1 && kernel.cols > 1) {
+    cv::Mat k64, w, u, vt;
+    kernel.convertTo(k64, CV_64F);
+    cv::SVD::compute(k64, w, u, vt);
+    const double s0 = w.at<double>(0);
+    int rank = 0;
+    while (rank < w.rows && w.at<double>(rank) > 1e-6 * s0) rank++;
+    // Each term costs two 1D passes plus an accumulation, so a low-rank
+    // decomposition is only taken when it saves a good share of the taps.
+    if (rank == 1 || (rank > 1 && rank * (kernel.rows + kernel.cols) * 3 <
+                                      kernel.rows * kernel.cols)) {
+      for (int i = 0; i < rank; i++) {
+        cv::Mat kx, ky;
+        vt.row(i).convertTo(kx, CV_32F);
+        u.col(i).convertTo(ky, CV_32F, w.at<double>(i));
+        plan.terms.emplace_back(kx, ky);
+      }
+      plan.path = ConvPlan::Path::separable;
+      return plan;
+    }
+  }
+  if (kernel.rows * kernel.cols > kDirectMaxArea) {
+    plan.path = ConvPlan::Path::dft;
+  }
+  return plan;
+}
+
+/**
+ * Bounded cache of kernel spectra keyed by kernel contents and DFT size.
+ */
+class SpectrumCache {
+ public:
+  cv::Mat get(const cv::Mat& kernel, int nh, int nw) {
+    std::string key(reinterpret_cast<const char*>(kernel.data),
+                    kernel.total() * kernel.elemSize());
+    for (const int v : {kernel.rows, kernel.cols, nh, nw}) {
+      key.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      for (const auto& [k, spec] : entries_) {
+        if (k == key) return spec;
+      }
+    }
+    cv::Mat padded = cv::Mat::zeros(nh, nw, CV_32FC1);
+    kernel.copyTo(padded(cv::Rect(0, 0, kernel.cols, kernel.rows)));
+    cv::Mat spec;
+    cv::dft(padded, spec, 0, kernel.rows);
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries_.emplace_back(std::move(key), spec);
+    if (entries_.size() > kSpectrumCacheSize) entries_.pop_front();
+    return spec;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::deque<std::pair<std::string, cv::Mat>> entries_;
+};
+
+SpectrumCache& spectrum_cache() {
+  static SpectrumCache cache;
+  return cache;
+}
+
+/**
+ * Correlates `src` with `kernel` by tiled overlap-save over DFT blocks.
+ * Produces the same result as cv::filter2D with a centered anchor.
+ */
+cv::Mat convolve_dft(const cv::Mat& src, const cv::Mat& kernel, int border) {
+  const int kh = kernel.rows;
+  const int kw = kernel.cols;
+  const int ay = kh / 2;
+  const int ax = kw / 2;
+
+  cv::Mat padded;
+  cv::copyMakeBorder(src, padded, ay, kh - 1 - ay, ax, kw - 1 - ax, border);
+  std::vector<cv::Mat> planes;
+  cv::split(padded, planes);
+
+  const int nh = cv::getOptimalDFTSize(
+      std::min(padded.rows, std::max(4 * kh, 256)));
+  const int nw = cv::getOptimalDFTSize(
+      std::min(padded.cols, std::max(4 * kw, 256)));
+  const int th = nh - kh + 1;
+  const int tw = nw - kw + 1;
+  const int tiles_y = (src.rows + th - 1) / th;
+  const int tiles_x = (src.cols + tw - 1) / tw;
+  const cv::Mat spec = spectrum_cache().get(kernel, nh, nw);
+
+  std::vector<cv::Mat> outs(planes.size());
+  for (auto& o : outs) o.create(src.rows, src.cols, CV_32FC1);
+
+  aznyan::parallel_for(0, tiles_y * tiles_x, [&](int t) {
+    const int ty = (t / tiles_x) * th;
+    const int tx = (t % tiles_x) * tw;
+    const int bh = std::min(nh, padded.rows - ty);
+    const int bw = std::min(nw, padded.cols - tx);
+    const int oh = std::min(th, src.rows - ty);
+    const int ow = std::min(tw, src.cols - tx);
+    cv::Mat block(nh, nw, CV_32FC1), block_spec;
+    for (std::size_t c = 0; c < planes.size(); c++) {
+      block.setTo(0.0);
+      planes[c](cv::Rect(tx, ty, bw, bh)).copyTo(block(cv::Rect(0, 0, bw, bh)));
+      cv::dft(block, block_spec, 0, bh);
+      cv::mulSpectrums(block_spec, spec, block_spec, 0, true);
+      cv::idft(block_spec, block, cv::DFT_SCALE | cv::DFT_REAL_OUTPUT, oh);
+      block(cv::Rect(0, 0, ow, oh)).copyTo(outs[c](cv::Rect(tx, ty, ow, oh)));
+    }
+  });
+
+  cv::Mat out;
+  cv::merge(outs, out);
+  return out;
+}
+
+void apply_convolution(const cv::Mat& src, cv::Mat& dst, const ConvPlan& plan,
+                       int border) {
+  switch (plan.path) {
+    case ConvPlan::Path::separable: {
+      cv::Mat acc, tmp;
+      for (const auto& [kx, ky] : plan.terms) {
+        cv::sepFilter2D(src, tmp, -1, kx, ky, cv::Point(-1, -1), 0.0, border);
+        if (acc.empty()) {
+          acc = tmp.clone();
+        } else {
+          cv::add(acc, tmp, acc);
+        }
+      }
+      dst = acc;
+      break;
+    }
+    case ConvPlan::Path::dft:
+      dst = convolve_dft(src, plan.kernel, border);
+      break;
+    default:
+      cv::filter2D(src, dst, -1, plan.kernel, cv::Point(-1, -1), 0.0, border);
+      break;
+  }
+}
+
+}  // namespace
+
 [[cpp11::register]]
 cpp11::integers azny_convolve(const cpp11::integers& nr, int height, int width,
                               const cpp11::doubles_matrix<>& kernel, int border,
@@ -66,17 +405,16 @@ cpp11::integers azny_convolve(const cpp11::integers& nr, int height, int width,
     }
   }
 
+  const ConvPlan plan = plan_convolution(filter);
   cv::Mat in1, in2, out1, out2;
 
   bgra[0].convertTo(in1, CV_32FC3, 1.0 / 255, 0.0);
-  cv::filter2D(in1, out1, -1, filter, cv::Point(-1, -1), 0.0,
-               aznyan::mode_a[border]);
+  apply_convolution(in1, out1, plan, aznyan::mode_a[border]);
   cv::convertScaleAbs(out1, out1, 255.0);
 
   if (alphasync) {
     bgra[1].convertTo(in2, CV_32FC1, 1.0 / 255, 0.0);
-    cv::filter2D(in2, out2, -1, filter, cv::Point(-1, -1), 0.0,
-                 aznyan::mode_a[border]);
+    apply_convolution(in2, out2, plan, aznyan::mode_a[border]);
     cv::convertScaleAbs(out2, out2, 255.0);
   } else {
     out2 = bgra[1];
@@ -90,63 +428,241 @@ cpp11::integers azny_kuwahara(const cpp11::integers& nr, int height, int width,
                               const cpp11::doubles_matrix<>& kernel2,
                               double beta, int border) {
   // Based on <https://qiita.com/Cartelet/items/7773cd56c7ce016476d9>
-  const auto calc_ev = [](const cv::Mat& aout, const cv::Mat& bout,
-                          const double& beta) {
-    cv::Mat v, v1ch;
-    cv::multiply(aout, aout, v);
-    v = bout - v;
-
-    if (v.channels() == 3) {
-      std::vector<cv::Mat> chs;
-      cv::split(v, chs);
-      v1ch = chs[0] + chs[1] + chs[2];
-    } else {
-      v1ch = v;
-    }
-    double vmax;
-    cv::minMaxLoc(v1ch, nullptr, &vmax);
-
-    if (vmax < 1e-12) vmax = 1e-12;
-    cv::Mat vn;
-    v1ch.convertTo(vn, CV_32F, 1.0 / vmax);
-
-    cv::Mat tmp = -beta * cv::abs(vn);
-    cv::Mat ev;
-    cv::exp(tmp, ev);
-
-    return ev;
-  };
-
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
   cv::Mat filter1(kernel1.nrow(), kernel1.ncol(), CV_64FC1, kernel1.data());
   filter1.convertTo(filter1, CV_32FC1);
   cv::Mat filter2(kernel2.nrow(), kernel2.ncol(), CV_64FC1, kernel2.data());
   filter2.convertTo(filter2, CV_32FC1);
 
-  cv::Mat in, out, a_out, b_out, c_out, d_out;
+  const ConvPlan plan1 = plan_convolution(filter1);
+  const ConvPlan plan2 = plan_convolution(filter2);
 
+  // Local mean and mean of squares, filtered together as one 6-channel image.
+  const float unit = static_cast<float>(1.0 / 255);
+  cv::Mat in(height, width, CV_32FC(6)), ab;
+  aznyan::parallel_for(0, height, [&](int y) {
+    const uchar* src = bgra[0].ptr<uchar>(y);
+    float* dst = in.ptr<float>(y);
+    for (int x = 0; x < width; x++) {
+      for (int c = 0; c < 3; c++) {
+        const float v = src[x * 3 + c] * unit;
+        dst[x * 6 + c] = v;
+        dst[x * 6 + 3 + c] = v * v;
+      }
+    }
+  });
+  apply_convolution(in, ab, plan1, aznyan::mode_a[border]);
+
+  // Variance summed over channels. The weights are normalized by its global
+  // maximum, which is reduced from per-row maxima.
+  cv::Mat var(height, width, CV_32FC1);
+  std::vector<float> row_max(height);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const float* p = ab.ptr<float>(y);
+    float* v = var.ptr<float>(y);
+    float vmax = -std::numeric_limits<float>::infinity();
+    for (int x = 0; x < width; x++) {
+      const float* px = p + x * 6;
+      v[x] = ((px[3] - px[0] * px[0]) + (px[4] - px[1] * px[1])) +
+             (px[5] - px[2] * px[2]);
+      vmax = std::max(vmax, v[x]);
+    }
+    row_max[y] = vmax;
+  });
+  double vmax = *std::max_element(row_max.begin(), row_max.end());
+  if (vmax < 1e-12) vmax = 1e-12;
+
+  // Softmax weights, and the weighted mean stacked with the weights so that
+  // both go through kernel2 in one pass.
+  const float scale = static_cast<float>(1.0 / vmax);
+  const float nbeta = static_cast<float>(-beta);
+  cv::Mat ev(height, width, CV_32FC4), cd;
+  aznyan::parallel_for(0, height, [&](int y) {
+    float* v = var.ptr<float>(y);
+    for (int x = 0; x < width; x++) {
+      v[x] = std::abs(v[x] * scale) * nbeta;
+    }
+    cv::Mat row = var.row(y);
+    cv::exp(row, row);
+    const float* p = ab.ptr<float>(y);
+    float* dst = ev.ptr<float>(y);
+    for (int x = 0; x < width; x++) {
+      for (int c = 0; c < 3; c++) dst[x * 4 + c] = p[x * 6 + c] * v[x];
+      dst[x * 4 + 3] = v[x];
+    }
+  });
+  apply_convolution(ev, cd, plan2, aznyan::mode_a[border]);
+
+  cv::Mat out(height, width, CV_8UC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const float* p = cd.ptr<float>(y);
+    uchar* dst = out.ptr<uchar>(y);
+    for (int x = 0; x < width; x++) {
+      // Kernels with negative taps can cancel the weights out; like
+      // cv::divide, a zero weight gives zero.
+      const float w = p[x * 4 + 3];
+      for (int c = 0; c < 3; c++) {
+        const float v = w != 0.f ? p[x * 4 + c] / w : 0.f;
+        dst[x * 3 + c] = cv::saturate_cast<uchar>(std::abs(v * 255.0f));
+      }
+    }
+  });
+
+  return aznyan::encode_nr(out, bgra[1]);
+}
+
+[[cpp11::register]]
+cpp11::integers azny_aniso_kuwahara(const cpp11::integers& nr, int height,
+                                    int width, int radius, double sigma,
+                                    double alpha, double hardness,
+                                    double sharpness, int border) {
+  // Anisotropic Kuwahara filter with polynomial sector weights.
+  // See Kyprianidis et al. (2009), "Image and Video Abstraction by
+  // Anisotropic Kuwahara Filtering", and Kyprianidis (2011).
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  cv::Mat in;
   bgra[0].convertTo(in, CV_32FC3, 1.0 / 255, 0.0);
-  cv::filter2D(in, a_out, -1, filter1, cv::Point(-1, -1), 0.0,
-               aznyan::mode_a[border]);
 
-  cv::Mat tmpA;
-  cv::multiply(in, in, tmpA);
-  cv::filter2D(tmpA, b_out, -1, filter1, cv::Point(-1, -1), 0.0,
-               aznyan::mode_a[border]);
+  // Structure tensor (E, F, G), summed over channels and smoothed.
+  cv::Mat gx, gy;
+  cv::Sobel(in, gx, CV_32F, 1, 0, 3, 1.0, 0.0, aznyan::mode_a[border]);
+  cv::Sobel(in, gy, CV_32F, 0, 1, 3, 1.0, 0.0, aznyan::mode_a[border]);
+  cv::Mat sst(height, width, CV_32FC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const float* px = gx.ptr<float>(y);
+    const float* py = gy.ptr<float>(y);
+    float* dst = sst.ptr<float>(y);
+    for (int x = 0; x < width; x++) {
+      float e = 0.0f, f = 0.0f, g = 0.0f;
+      for (int c = 0; c < 3; c++) {
+        const float dx = px[x * 3 + c];
+        const float dy = py[x * 3 + c];
+        e += dx * dx;
+        f += dx * dy;
+        g += dy * dy;
+      }
+      dst[x * 3 + 0] = e;
+      dst[x * 3 + 1] = f;
+      dst[x * 3 + 2] = g;
+    }
+  });
+  if (sigma > 0.0) {
+    cv::GaussianBlur(sst, sst, cv::Size(0, 0), sigma, sigma,
+                     aznyan::mode_a[border]);
+  }
 
-  cv::Mat ev = calc_ev(a_out, b_out, beta);
+  // The elliptical window spans at most twice the radius along its axes.
+  const int pad = 2 * radius + 1;
+  cv::Mat src;
+  cv::copyMakeBorder(in, src, pad, pad, pad, pad, aznyan::mode_a[border]);
 
-  cv::Mat tmpB, tmp_ev;
-  cv::merge(std::vector<cv::Mat>{ev, ev, ev}, tmp_ev);
-  cv::multiply(a_out, tmp_ev, tmpB);
+  constexpr int kSectors = 8;
+  const float zeta = 2.0f / radius;
+  const float zero_crossing = 0.58f;
+  const float sin_zc = std::sin(zero_crossing);
+  const float eta = (zeta + std::cos(zero_crossing)) / (sin_zc * sin_zc);
+  const float al = static_cast<float>(alpha);
+  const float hard = static_cast<float>(hardness) * 1000.0f;
+  const float q = static_cast<float>(sharpness) * 0.5f;
+  const float half_sqrt2 = std::sqrt(2.0f) / 2.0f;
 
-  cv::filter2D(tmpB, c_out, -1, filter2, cv::Point(-1, -1), 0.0,
-               aznyan::mode_a[border]);
-  cv::filter2D(tmp_ev, d_out, -1, filter2, cv::Point(-1, -1), 0.0,
-               aznyan::mode_a[border]);
+  cv::Mat out(height, width, CV_8UC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const float* t = sst.ptr<float>(y);
+    uchar* dst = out.ptr<uchar>(y);
+    for (int x = 0; x < width; x++) {
+      // Orientation and anisotropy from the eigenvectors of the tensor.
+      const float e = t[x * 3 + 0], f = t[x * 3 + 1], g = t[x * 3 + 2];
+      const float disc = std::sqrt((e - g) * (e - g) + 4.0f * f * f);
+      const float l1 = 0.5f * (e + g + disc);
+      const float l2 = 0.5f * (e + g - disc);
+      float tx = l1 - e, ty = -f;
+      const float len = std::sqrt(tx * tx + ty * ty);
+      if (len > 0.0f) {
+        tx /= len;
+        ty /= len;
+      } else {
+        tx = 0.0f;
+        ty = 1.0f;
+      }
+      const float phi = -std::atan2(ty, tx);
+      const float aniso = l1 + l2 > 0.0f ? (l1 - l2) / (l1 + l2) : 0.0f;
 
-  cv::divide(c_out, d_out, out);
-  cv::convertScaleAbs(out, out, 255.0);
+      const float ea = radius * clampf((al + aniso) / al, 0.1f, 2.0f);
+      const float eb = radius * clampf(al / (al + aniso), 0.1f, 2.0f);
+      const float cos_phi = std::cos(phi);
+      const float sin_phi = std::sin(phi);
+      const float sr00 = 0.5f / ea * cos_phi, sr01 = -0.5f / ea * sin_phi;
+      const float sr10 = 0.5f / eb * sin_phi, sr11 = 0.5f / eb * cos_phi;
+      const int max_x = static_cast<int>(std::sqrt(
+          ea * ea * cos_phi * cos_phi + eb * eb * sin_phi * sin_phi));
+      const int max_y = static_cast<int>(std::sqrt(
+          ea * ea * sin_phi * sin_phi + eb * eb * cos_phi * cos_phi));
+
+      std::array<std::array<float, 4>, kSectors> m{};
+      std::array<std::array<float, 3>, kSectors> s2{};
+      for (int dy = -max_y; dy <= max_y; dy++) {
+        const float* row = src.ptr<float>(y + pad + dy);
+        for (int dx = -max_x; dx <= max_x; dx++) {
+          float vx = sr00 * dx + sr01 * dy;
+          float vy = sr10 * dx + sr11 * dy;
+          if (vx * vx + vy * vy > 0.25f) continue;
+          const float* c = row + (x + pad + dx) * 3;
+
+          std::array<float, kSectors> w;
+          float vxx = zeta - eta * vx * vx;
+          float vyy = zeta - eta * vy * vy;
+          w[0] = std::max(0.0f, vy + vxx);
+          w[2] = std::max(0.0f, -vx + vyy);
+          w[4] = std::max(0.0f, -vy + vxx);
+          w[6] = std::max(0.0f, vx + vyy);
+          const float rx = half_sqrt2 * (vx - vy);
+          const float ry = half_sqrt2 * (vx + vy);
+          vx = rx;
+          vy = ry;
+          vxx = zeta - eta * vx * vx;
+          vyy = zeta - eta * vy * vy;
+          w[1] = std::max(0.0f, vy + vxx);
+          w[3] = std::max(0.0f, -vx + vyy);
+          w[5] = std::max(0.0f, -vy + vxx);
+          w[7] = std::max(0.0f, vx + vyy);
+          float sum = 0.0f;
+          for (auto& wk : w) {
+            wk *= wk;
+            sum += wk;
+          }
+          const float gauss = std::exp(-3.125f * (vx * vx + vy * vy)) / sum;
+          for (int k = 0; k < kSectors; k++) {
+            const float wk = w[k] * gauss;
+            for (int i = 0; i < 3; i++) {
+              m[k][i] += c[i] * wk;
+              s2[k][i] += c[i] * c[i] * wk;
+            }
+            m[k][3] += wk;
+          }
+        }
+      }
+
+      // Blend the sector means, favoring sectors of low variance.
+      std::array<float, 3> acc{};
+      float wsum = 0.0f;
+      for (int k = 0; k < kSectors; k++) {
+        if (m[k][3] <= 0.0f) continue;
+        float var = 0.0f;
+        std::array<float, 3> mean;
+        for (int i = 0; i < 3; i++) {
+          mean[i] = m[k][i] / m[k][3];
+          var += std::abs(s2[k][i] / m[k][3] - mean[i] * mean[i]);
+        }
+        const float wk = 1.0f / (1.0f + std::pow(hard * var, q));
+        for (int i = 0; i < 3; i++) acc[i] += mean[i] * wk;
+        wsum += wk;
+      }
+      for (int i = 0; i < 3; i++) {
+        dst[x * 3 + i] = cv::saturate_cast<uchar>(acc[i] / wsum * 255.0f);
+      }
+    }
+  });
 
   return aznyan::encode_nr(out, bgra[1]);
 }
@@ -1,97 +1,253 @@
-#include "aznyan_types.h"
-
-[[cpp11::register]]
-cpp11::integers azny_blurhash(const cpp11::integers& nr, int height, int width,
-                              int x_comps, int y_comps) {
-  if (x_comps <= 0 || y_comps <= 0) {
-    cpp11::stop("Both x_comps and y_comps must be greater than 0.");
+#include "aznyan_color.h"
+#include <array>
+#include <cstring>
+#include <string>
+
+namespace {
+
+constexpr char kBase83[] =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz#$%*+,-.:;=?@[]^_{|}~";
+
+/**
+ * Cosine table of `comps` rows by `n` samples, where row `k` holds
+ * cos(pi * k * (x + offset) / n). The effect samples at pixel centres
+ * (offset 0.5), while the BlurHash format samples at pixel edges (0).
+ */
+std::vector<float> cos_table(int n, int comps, float offset) {
+  std::vector<float> tab(static_cast<size_t>(n) * comps);
+  for (int k = 0; k < comps; k++) {
+    for (int x = 0; x < n; x++) {
+      tab[k * n + x] =
+          std::cos(static_cast<float>(M_PI) * k * (x + offset) / n);
+    }
   }
-  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
-
-  cv::Mat tmpB;  // BGR (float)
-  bgra[0].convertTo(tmpB, CV_32FC3, 1.0 / 255.0);
+  return tab;
+}
 
-  cv::Mat imgLin(tmpB.size(), CV_32FC3);
+/**
+ * Projects a linear RGB image (CV_32FC3, in RGB order) onto the first
+ * `x_comps` x `y_comps` cosine components and returns the mean of each
+ * product, row-major by component. Rows are projected in parallel first,
+ * so the column pass only touches `height * x_comps` values.
+ */
+std::vector<cv::Vec3f> project(const cv::Mat& lin, int x_comps, int y_comps,
+                               float offset) {
+  const int height = lin.rows, width = lin.cols;
+  const std::vector<float> cx = cos_table(width, x_comps, offset);
+  const std::vector<float> cy = cos_table(height, y_comps, offset);
+
+  cv::Mat rows(height, x_comps, CV_64FC3);
   aznyan::parallel_for(0, height, [&](int y) {
-    for (int x = 0; x < width; x++) {
-      const cv::Vec3f& px = tmpB.at<cv::Vec3f>(y, x);
-      imgLin.at<cv::Vec3f>(y, x) = cv::Vec3f(srgb_to_linear(px[2]),  // R
-                                             srgb_to_linear(px[1]),  // G
-                                             srgb_to_linear(px[0])   // B
-      );
+    const cv::Vec3f* src = lin.ptr<cv::Vec3f>(y);
+    cv::Vec3d* dst = rows.ptr<cv::Vec3d>(y);
+    for (int i = 0; i < x_comps; i++) {
+      const float* c = &cx[i * width];
+      double r = 0, g = 0, b = 0;
+      for (int x = 0; x < width; x++) {
+        r += src[x][0] * c[x];
+        g += src[x][1] * c[x];
+        b += src[x][2] * c[x];
+      }
+      dst[i] = cv::Vec3d(r, g, b);
     }
   });
 
-  cv::Mat currents = cv::Mat::zeros(y_comps, x_comps, CV_32FC3);
-  for (int j = 0; j < y_comps; j++) {
-    for (int i = 0; i < x_comps; i++) {
-      const int nthreads = cv::getNumThreads();
-      std::vector<cv::Vec3f> partial(nthreads, cv::Vec3f(0, 0, 0));
+  const double scale = 1.0 / (static_cast<double>(width) * height);
+  std::vector<cv::Vec3f> coeffs(static_cast<size_t>(x_comps) * y_comps);
+  aznyan::parallel_for(0, y_comps * x_comps, [&](int k) {
+    const int j = k / x_comps, i = k % x_comps;
+    const float* c = &cy[j * height];
+    cv::Vec3d acc(0, 0, 0);
+    for (int y = 0; y < height; y++) {
+      acc += rows.at<cv::Vec3d>(y, i) * static_cast<double>(c[y]);
+    }
+    coeffs[k] = cv::Vec3f(acc * scale);
+  });
+  return coeffs;
+}
 
-      aznyan::parallel_for(0, height, [&](int y) {
-        const int tid = cv::getThreadNum();
-        cv::Vec3f local(0, 0, 0);
+/**
+ * Sums the cosine components back into a CV_8UC3 BGR image. `to_byte`
+ * converts one linear channel value to its 8-bit sRGB encoding.
+ */
+template <typename ToByte>
+cv::Mat reconstruct(const std::vector<cv::Vec3f>& coeffs, int x_comps,
+                    int y_comps, int height, int width, float offset,
+                    ToByte to_byte) {
+  const std::vector<float> cx = cos_table(width, x_comps, offset);
+  const std::vector<float> cy = cos_table(height, y_comps, offset);
+
+  cv::Mat out(height, width, CV_8UC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    // Fold the vertical basis into one coefficient per column component.
+    std::vector<cv::Vec3f> row(x_comps, cv::Vec3f(0, 0, 0));
+    for (int j = 0; j < y_comps; j++) {
+      const float c = cy[j * height + y];
+      for (int i = 0; i < x_comps; i++) {
+        row[i] += coeffs[j * x_comps + i] * c;
+      }
+    }
+    cv::Vec3b* dst = out.ptr<cv::Vec3b>(y);
+    for (int x = 0; x < width; x++) {
+      float r = 0.f, g = 0.f, b = 0.f;
+      for (int i = 0; i < x_comps; i++) {
+        const float c = cx[i * width + x];
+        r += row[i][0] * c;
+        g += row[i][1] * c;
+        b += row[i][2] * c;
+      }
+      dst[x] = cv::Vec3b(to_byte(b), to_byte(g), to_byte(r));
+    }
+  });
+  return out;
+}
 
-        const float fy = (y + .5f) / height;
-        const float cy = std::cos(M_PI * j * fy);
+cv::Mat to_linear_rgb(const cv::Mat& bgr) {
+  const std::array<float, 256>& lut = aznyan::srgb_lut();
+  cv::Mat lin(bgr.size(), CV_32FC3);
+  aznyan::parallel_for(0, bgr.rows, [&](int y) {
+    const cv::Vec3b* src = bgr.ptr<cv::Vec3b>(y);
+    cv::Vec3f* dst = lin.ptr<cv::Vec3f>(y);
+    for (int x = 0; x < bgr.cols; x++) {
+      dst[x] = cv::Vec3f(lut[src[x][2]], lut[src[x][1]], lut[src[x][0]]);
+    }
+  });
+  return lin;
+}
 
-        for (int x = 0; x < width; x++) {
-          const float fx = (x + .5f) / width;
-          const float cx = std::cos(M_PI * i * fx);
-          const float basis = cx * cy;
-          const cv::Vec3f& px = imgLin.at<cv::Vec3f>(y, x);
-          local += px * basis;
-        }
+// Rounded sRGB encoding used by the BlurHash format.
+inline int linear_to_byte(float v) { return aznyan::srgb_encoder()(v); }
 
-        partial[tid] += local;
-      });
+inline float sign_pow(float v, float e) {
+  return std::copysign(std::pow(std::abs(v), e), v);
+}
 
-      // reduce
-      cv::Vec3f sum(0, 0, 0);
-      for (auto& p : partial) sum += p;
+void encode83(int value, int length, std::string& out) {
+  int divisor = 1;
+  for (int i = 1; i < length; i++) divisor *= 83;
+  for (int i = 0; i < length; i++) {
+    out.push_back(kBase83[(value / divisor) % 83]);
+    divisor /= 83;
+  }
+}
 
-      const float scale = 1.0f / (width * height);
-      currents.at<cv::Vec3f>(j, i) = sum * scale;
+int decode83(const std::string& str, size_t from, size_t to) {
+  int value = 0;
+  for (size_t i = from; i < to; i++) {
+    const char* p = std::strchr(kBase83, str[i]);
+    if (str[i] == '\0' || p == nullptr) {
+      cpp11::stop("Invalid character in BlurHash string.");
     }
-    cpp11::check_user_interrupt();
+    value = value * 83 + static_cast<int>(p - kBase83);
   }
+  return value;
+}
 
-  cv::Mat outBGR(tmpB.size(), CV_8UC3);
-  aznyan::parallel_for(0, height, [&](int y) {
-    const float fy = (y + .5f) / height;
+}  // namespace
 
-    for (int x = 0; x < width; x++) {
-      const float fx = (x + .5f) / width;
+[[cpp11::register]]
+cpp11::integers azny_blurhash(const cpp11::integers& nr, int height, int width,
+                              int x_comps, int y_comps) {
+  if (x_comps <= 0 || y_comps <= 0) {
+    cpp11::stop("Both x_comps and y_comps must be greater than 0.");
+  }
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
 
-      // --- 1. DCT reconstruction （Linear RGB） ---
-      float r = 0.f, g = 0.f, b = 0.f;
+  const cv::Mat imgLin = to_linear_rgb(bgra[0]);
+  const std::vector<cv::Vec3f> currents =
+      project(imgLin, x_comps, y_comps, .5f);
 
-      for (int j = 0; j < y_comps; j++) {
-        const float cy = std::cos((float)M_PI * j * fy);
+  // The effect truncates to 8-bit rather than rounding.
+  const aznyan::ByteEncoder to_byte(srgb_to_linear, 0.f);
+  cv::Mat outBGR = reconstruct(currents, x_comps, y_comps, height, width, .5f,
+                               [&](float v) { return to_byte(v); });
+  return aznyan::encode_nr(outBGR, bgra[1]);
+}
 
-        for (int i = 0; i < x_comps; i++) {
-          const float cx = std::cos((float)M_PI * i * fx);
-          const float basis = cx * cy;
+[[cpp11::register]]
+std::string azny_blurhash_encode(const cpp11::integers& nr, int height,
+                                 int width, int x_comps, int y_comps) {
+  if (x_comps < 1 || x_comps > 9 || y_comps < 1 || y_comps > 9) {
+    cpp11::stop("Both x_comps and y_comps must be between 1 and 9.");
+  }
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
 
-          const cv::Vec3f& c = currents.at<cv::Vec3f>(j, i);  // Linear RGB
-          r += c[0] * basis;
-          g += c[1] * basis;
-          b += c[2] * basis;
-        }
+  std::vector<cv::Vec3f> factors =
+      project(to_linear_rgb(bgra[0]), x_comps, y_comps, 0.f);
+  // AC components are normalised by 2 in the format.
+  for (size_t k = 1; k < factors.size(); k++) factors[k] *= 2.f;
+
+  std::string hash;
+  hash.reserve(4 + 2 * factors.size());
+  encode83((x_comps - 1) + (y_comps - 1) * 9, 1, hash);
+
+  float max_value = 1.f;
+  if (factors.size() > 1) {
+    float actual_max = 0.f;
+    for (size_t k = 1; k < factors.size(); k++) {
+      for (int c = 0; c < 3; c++) {
+        actual_max = std::max(actual_max, std::abs(factors[k][c]));
       }
+    }
+    const int quantised = std::clamp(
+        static_cast<int>(std::floor(actual_max * 166.f - .5f)), 0, 82);
+    max_value = (quantised + 1) / 166.f;
+    encode83(quantised, 1, hash);
+  } else {
+    encode83(0, 1, hash);
+  }
 
-      // --- 2. Linear RGB -> sRGB ---
-      const float sr = linear_to_srgb(r);
-      const float sg = linear_to_srgb(g);
-      const float sb = linear_to_srgb(b);
+  const cv::Vec3f& dc = factors[0];
+  encode83((linear_to_byte(dc[0]) << 16) + (linear_to_byte(dc[1]) << 8) +
+               linear_to_byte(dc[2]),
+           4, hash);
+  for (size_t k = 1; k < factors.size(); k++) {
+    int value = 0;
+    for (int c = 0; c < 3; c++) {
+      const float q =
+          std::floor(sign_pow(factors[k][c] / max_value, .5f) * 9.f + 9.5f);
+      value = value * 19 + std::clamp(static_cast<int>(q), 0, 18);
+    }
+    encode83(value, 2, hash);
+  }
+  return hash;
+}
 
-      // --- 3. 8bit BGR ---
-      outBGR.at<cv::Vec3b>(y, x) =
-          cv::Vec3b((uchar)(std::clamp(sb, 0.f, 1.f) * 255.f),   // B
-                    (uchar)(std::clamp(sg, 0.f, 1.f) * 255.f),   // G
-                    (uchar)(std::clamp(sr, 0.f, 1.f) * 255.f));  // R
+[[cpp11::register]]
+cpp11::integers azny_blurhash_decode(const std::string& hash, int height,
+                                     int width, double punch) {
+  if (hash.size() < 6) {
+    cpp11::stop("BlurHash string must be at least 6 characters long.");
+  }
+  const int size_flag = decode83(hash, 0, 1);
+  const int x_comps = size_flag % 9 + 1;
+  const int y_comps = size_flag / 9 + 1;
+  if (hash.size() != static_cast<size_t>(4 + 2 * x_comps * y_comps)) {
+    cpp11::stop("BlurHash string has an invalid length.");
+  }
+  const float max_value =
+      static_cast<float>(decode83(hash, 1, 2) + 1) / 166.f * punch;
+
+  std::vector<cv::Vec3f> colors(static_cast<size_t>(x_comps) * y_comps);
+  const int dc = decode83(hash, 2, 6);
+  if (dc >= (1 << 24)) {
+    cpp11::stop("Invalid DC component in BlurHash string.");
+  }
+  const std::array<float, 256>& lut = aznyan::srgb_lut();
+  colors[0] = cv::Vec3f(lut[dc >> 16], lut[(dc >> 8) & 255], lut[dc & 255]);
+  for (size_t k = 1; k < colors.size(); k++) {
+    const size_t at = 4 + 2 * k;
+    const int value = decode83(hash, at, at + 2);
+    const int q[3] = {value / (19 * 19), (value / 19) % 19, value % 19};
+    for (int c = 0; c < 3; c++) {
+      colors[k][c] = sign_pow((q[c] - 9) / 9.f, 2.f) * max_value;
     }
-  });
+  }
 
-  return aznyan::encode_nr(outBGR, bgra[1]);
+  cv::Mat outBGR =
+      reconstruct(colors, x_comps, y_comps, height, width, 0.f,
+                  [](float v) { return aznyan::srgb_encoder()(v); });
+  cv::Mat alpha(height, width, CV_8UC1, cv::Scalar(255));
+  return aznyan::encode_nr(outBGR, alpha);
 }
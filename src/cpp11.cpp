@@ -188,6 +188,13 @@ extern "C" SEXP _aznyan_azny_bilateral(SEXP nr, SEXP height, SEXP width, SEXP d,
   END_CPP11
 }
 // blur.cpp
+cpp11::integers azny_bilateralgrid(const cpp11::integers& nr, int height, int width, int d, double sigmacolor, double sigmaspace, int border, bool alphasync);
+extern "C" SEXP _aznyan_azny_bilateralgrid(SEXP nr, SEXP height, SEXP width, SEXP d, SEXP sigmacolor, SEXP sigmaspace, SEXP border, SEXP alphasync) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_bilateralgrid(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(d), cpp11::as_cpp<cpp11::decay_t<double>>(sigmacolor), cpp11::as_cpp<cpp11::decay_t<double>>(sigmaspace), cpp11::as_cpp<cpp11::decay_t<int>>(border), cpp11::as_cpp<cpp11::decay_t<bool>>(alphasync)));
+  END_CPP11
+}
+// blur.cpp
 cpp11::integers azny_convolve(const cpp11::integers& nr, int height, int width, const cpp11::doubles_matrix<>& kernel, int border, bool alphasync);
 extern "C" SEXP _aznyan_azny_convolve(SEXP nr, SEXP height, SEXP width, SEXP kernel, SEXP border, SEXP alphasync) {
   BEGIN_CPP11
@@ -201,6 +208,13 @@ extern "C" SEXP _aznyan_azny_kuwahara(SEXP nr, SEXP height, SEXP width, SEXP ker
     return cpp11::as_sexp(azny_kuwahara(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<const cpp11::doubles_matrix<>&>>(kernel1), cpp11::as_cpp<cpp11::decay_t<const cpp11::doubles_matrix<>&>>(kernel2), cpp11::as_cpp<cpp11::decay_t<double>>(beta), cpp11::as_cpp<cpp11::decay_t<int>>(border)));
   END_CPP11
 }
+// blur.cpp
+cpp11::integers azny_aniso_kuwahara(const cpp11::integers& nr, int height, int width, int radius, double sigma, double alpha, double hardness, double sharpness, int border);
+extern "C" SEXP _aznyan_azny_aniso_kuwahara(SEXP nr, SEXP height, SEXP width, SEXP radius, SEXP sigma, SEXP alpha, SEXP hardness, SEXP sharpness, SEXP border) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_aniso_kuwahara(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(radius), cpp11::as_cpp<cpp11::decay_t<double>>(sigma), cpp11::as_cpp<cpp11::decay_t<double>>(alpha), cpp11::as_cpp<cpp11::decay_t<double>>(hardness), cpp11::as_cpp<cpp11::decay_t<double>>(sharpness), cpp11::as_cpp<cpp11::decay_t<int>>(border)));
+  END_CPP11
+}
 // blurhash.cpp
 cpp11::integers azny_blurhash(const cpp11::integers& nr, int height, int width, int x_comps, int y_comps);
 extern "C" SEXP _aznyan_azny_blurhash(SEXP nr, SEXP height, SEXP width, SEXP x_comps, SEXP y_comps) {
@@ -208,6 +222,20 @@ extern "C" SEXP _aznyan_azny_blurhash(SEXP nr, SEXP height, SEXP width, SEXP x_c
     return cpp11::as_sexp(azny_blurhash(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(x_comps), cpp11::as_cpp<cpp11::decay_t<int>>(y_comps)));
   END_CPP11
 }
+// blurhash.cpp
+std::string azny_blurhash_encode(const cpp11::integers& nr, int height, int width, int x_comps, int y_comps);
+extern "C" SEXP _aznyan_azny_blurhash_encode(SEXP nr, SEXP height, SEXP width, SEXP x_comps, SEXP y_comps) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_blurhash_encode(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(x_comps), cpp11::as_cpp<cpp11::decay_t<int>>(y_comps)));
+  END_CPP11
+}
+// blurhash.cpp
+cpp11::integers azny_blurhash_decode(const std::string& hash, int height, int width, double punch);
+extern "C" SEXP _aznyan_azny_blurhash_decode(SEXP hash, SEXP height, SEXP width, SEXP punch) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_blurhash_decode(cpp11::as_cpp<cpp11::decay_t<const std::string&>>(hash), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<double>>(punch)));
+  END_CPP11
+}
 // color-filters.cpp
 cpp11::integers azny_color_filter(const cpp11::integers& nr, int height, int width, int filter_id);
 extern "C" SEXP _aznyan_azny_color_filter(SEXP nr, SEXP height, SEXP width, SEXP filter_id) {
@@ -335,10 +363,24 @@ extern "C" SEXP _aznyan_azny_unpremul(SEXP nr, SEXP height, SEXP width, SEXP max
   END_CPP11
 }
 // diffusion.cpp
-cpp11::integers azny_diffusion(const cpp11::integers& nr, int height, int width, double decay_factor, double decay_offset, double gamma, int sigma);
-extern "C" SEXP _aznyan_azny_diffusion(SEXP nr, SEXP height, SEXP width, SEXP decay_factor, SEXP decay_offset, SEXP gamma, SEXP sigma) {
+cpp11::integers azny_diffusion(const cpp11::integers& nr, int height, int width, double decay_factor, double decay_offset, double gamma, int sigma, int iterations);
+extern "C" SEXP _aznyan_azny_diffusion(SEXP nr, SEXP height, SEXP width, SEXP decay_factor, SEXP decay_offset, SEXP gamma, SEXP sigma, SEXP iterations) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_diffusion(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<double>>(decay_factor), cpp11::as_cpp<cpp11::decay_t<double>>(decay_offset), cpp11::as_cpp<cpp11::decay_t<double>>(gamma), cpp11::as_cpp<cpp11::decay_t<int>>(sigma), cpp11::as_cpp<cpp11::decay_t<int>>(iterations)));
+  END_CPP11
+}
+// diffusion.cpp
+cpp11::integers azny_bloom(const cpp11::integers& nr, int height, int width, double threshold, double intensity, int levels, double falloff);
+extern "C" SEXP _aznyan_azny_bloom(SEXP nr, SEXP height, SEXP width, SEXP threshold, SEXP intensity, SEXP levels, SEXP falloff) {
   BEGIN_CPP11
-    return cpp11::as_sexp(azny_diffusion(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<double>>(decay_factor), cpp11::as_cpp<cpp11::decay_t<double>>(decay_offset), cpp11::as_cpp<cpp11::decay_t<double>>(gamma), cpp11::as_cpp<cpp11::decay_t<int>>(sigma)));
+    return cpp11::as_sexp(azny_bloom(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<double>>(threshold), cpp11::as_cpp<cpp11::decay_t<double>>(intensity), cpp11::as_cpp<cpp11::decay_t<int>>(levels), cpp11::as_cpp<cpp11::decay_t<double>>(falloff)));
+  END_CPP11
+}
+// dither.cpp
+cpp11::integers azny_dither(const cpp11::integers& nr, int height, int width, const cpp11::integers& palette, int method);
+extern "C" SEXP _aznyan_azny_dither(SEXP nr, SEXP height, SEXP width, SEXP palette, SEXP method) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_dither(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(palette), cpp11::as_cpp<cpp11::decay_t<int>>(method)));
   END_CPP11
 }
 // edge-canny.cpp
@@ -355,6 +397,20 @@ extern "C" SEXP _aznyan_azny_cannyrgb(SEXP nr, SEXP height, SEXP width, SEXP asi
     return cpp11::as_sexp(azny_cannyrgb(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(asize), cpp11::as_cpp<cpp11::decay_t<bool>>(balp), cpp11::as_cpp<cpp11::decay_t<bool>>(gradient), cpp11::as_cpp<cpp11::decay_t<double>>(thres1), cpp11::as_cpp<cpp11::decay_t<double>>(thres2)));
   END_CPP11
 }
+// edge-canny.cpp
+SEXP azny_canny_gradient(const cpp11::integers& nr, int height, int width, int asize, bool use_rgb);
+extern "C" SEXP _aznyan_azny_canny_gradient(SEXP nr, SEXP height, SEXP width, SEXP asize, SEXP use_rgb) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_canny_gradient(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(asize), cpp11::as_cpp<cpp11::decay_t<bool>>(use_rgb)));
+  END_CPP11
+}
+// edge-canny.cpp
+cpp11::integers azny_canny_apply(SEXP handle, bool balp, bool gradient, double thres1, double thres2);
+extern "C" SEXP _aznyan_azny_canny_apply(SEXP handle, SEXP balp, SEXP gradient, SEXP thres1, SEXP thres2) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_canny_apply(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle), cpp11::as_cpp<cpp11::decay_t<bool>>(balp), cpp11::as_cpp<cpp11::decay_t<bool>>(gradient), cpp11::as_cpp<cpp11::decay_t<double>>(thres1), cpp11::as_cpp<cpp11::decay_t<double>>(thres2)));
+  END_CPP11
+}
 // edge-laplacian.cpp
 cpp11::integers azny_laplacianfilter(const cpp11::integers& nr, int height, int width, int ksize, bool balp, int border, double scale, double delta);
 extern "C" SEXP _aznyan_azny_laplacianfilter(SEXP nr, SEXP height, SEXP width, SEXP ksize, SEXP balp, SEXP border, SEXP scale, SEXP delta) {
@@ -383,6 +439,13 @@ extern "C" SEXP _aznyan_azny_sobelrgb(SEXP nr, SEXP height, SEXP width, SEXP ksi
     return cpp11::as_sexp(azny_sobelrgb(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(ksize), cpp11::as_cpp<cpp11::decay_t<bool>>(balp), cpp11::as_cpp<cpp11::decay_t<int>>(dx), cpp11::as_cpp<cpp11::decay_t<int>>(dy), cpp11::as_cpp<cpp11::decay_t<int>>(border), cpp11::as_cpp<cpp11::decay_t<double>>(scale), cpp11::as_cpp<cpp11::decay_t<double>>(delta)));
   END_CPP11
 }
+// edge-sobel.cpp
+cpp11::list azny_sobel_gradient(const cpp11::integers& nr, int height, int width, int ksize, int border, double scale, bool orientation);
+extern "C" SEXP _aznyan_azny_sobel_gradient(SEXP nr, SEXP height, SEXP width, SEXP ksize, SEXP border, SEXP scale, SEXP orientation) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_sobel_gradient(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(ksize), cpp11::as_cpp<cpp11::decay_t<int>>(border), cpp11::as_cpp<cpp11::decay_t<double>>(scale), cpp11::as_cpp<cpp11::decay_t<bool>>(orientation)));
+  END_CPP11
+}
 // image-io.cpp
 cpp11::integers azny_read_still(const std::string& filename);
 extern "C" SEXP _aznyan_azny_read_still(SEXP filename) {
@@ -418,6 +481,90 @@ extern "C" SEXP _aznyan_azny_write_animation(SEXP frames, SEXP filename, SEXP du
     return cpp11::as_sexp(azny_write_animation(cpp11::as_cpp<cpp11::decay_t<const std::vector<std::string>&>>(frames), cpp11::as_cpp<cpp11::decay_t<const std::string&>>(filename), cpp11::as_cpp<cpp11::decay_t<int>>(duration), cpp11::as_cpp<cpp11::decay_t<int>>(quality), cpp11::as_cpp<cpp11::decay_t<int>>(loop_count)));
   END_CPP11
 }
+// image-io.cpp
+SEXP azny_animation_writer(const std::string& filename, int quality, int loop_count);
+extern "C" SEXP _aznyan_azny_animation_writer(SEXP filename, SEXP quality, SEXP loop_count) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_animation_writer(cpp11::as_cpp<cpp11::decay_t<const std::string&>>(filename), cpp11::as_cpp<cpp11::decay_t<int>>(quality), cpp11::as_cpp<cpp11::decay_t<int>>(loop_count)));
+  END_CPP11
+}
+// image-io.cpp
+int azny_animation_push(SEXP handle, const cpp11::integers& nr, int height, int width, int duration);
+extern "C" SEXP _aznyan_azny_animation_push(SEXP handle, SEXP nr, SEXP height, SEXP width, SEXP duration) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_animation_push(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(duration)));
+  END_CPP11
+}
+// image-io.cpp
+std::string azny_animation_close(SEXP handle);
+extern "C" SEXP _aznyan_azny_animation_close(SEXP handle) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_animation_close(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle)));
+  END_CPP11
+}
+// image-io.cpp
+SEXP azny_animation_reader(const std::string& filename);
+extern "C" SEXP _aznyan_azny_animation_reader(SEXP filename) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_animation_reader(cpp11::as_cpp<cpp11::decay_t<const std::string&>>(filename)));
+  END_CPP11
+}
+// image-io.cpp
+int azny_animation_count(SEXP handle);
+extern "C" SEXP _aznyan_azny_animation_count(SEXP handle) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_animation_count(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle)));
+  END_CPP11
+}
+// image-io.cpp
+cpp11::list azny_animation_read(SEXP handle, int start, int count);
+extern "C" SEXP _aznyan_azny_animation_read(SEXP handle, SEXP start, SEXP count) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_animation_read(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle), cpp11::as_cpp<cpp11::decay_t<int>>(start), cpp11::as_cpp<cpp11::decay_t<int>>(count)));
+  END_CPP11
+}
+// linear.cpp
+SEXP azny_linear_decode(const cpp11::integers& nr, int height, int width);
+extern "C" SEXP _aznyan_azny_linear_decode(SEXP nr, SEXP height, SEXP width) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_linear_decode(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width)));
+  END_CPP11
+}
+// linear.cpp
+cpp11::integers azny_linear_encode(SEXP handle);
+extern "C" SEXP _aznyan_azny_linear_encode(SEXP handle) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_linear_encode(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle)));
+  END_CPP11
+}
+// linear.cpp
+cpp11::integers azny_linear_dim(SEXP handle);
+extern "C" SEXP _aznyan_azny_linear_dim(SEXP handle) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_linear_dim(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle)));
+  END_CPP11
+}
+// linear.cpp
+SEXP azny_linear_boxblur(SEXP handle, int boxW, int boxH, bool normalize, int border);
+extern "C" SEXP _aznyan_azny_linear_boxblur(SEXP handle, SEXP boxW, SEXP boxH, SEXP normalize, SEXP border) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_linear_boxblur(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle), cpp11::as_cpp<cpp11::decay_t<int>>(boxW), cpp11::as_cpp<cpp11::decay_t<int>>(boxH), cpp11::as_cpp<cpp11::decay_t<bool>>(normalize), cpp11::as_cpp<cpp11::decay_t<int>>(border)));
+  END_CPP11
+}
+// linear.cpp
+SEXP azny_linear_gaussianblur(SEXP handle, int boxW, int boxH, double sigmaX, double sigmaY, int border);
+extern "C" SEXP _aznyan_azny_linear_gaussianblur(SEXP handle, SEXP boxW, SEXP boxH, SEXP sigmaX, SEXP sigmaY, SEXP border) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_linear_gaussianblur(cpp11::as_cpp<cpp11::decay_t<SEXP>>(handle), cpp11::as_cpp<cpp11::decay_t<int>>(boxW), cpp11::as_cpp<cpp11::decay_t<int>>(boxH), cpp11::as_cpp<cpp11::decay_t<double>>(sigmaX), cpp11::as_cpp<cpp11::decay_t<double>>(sigmaY), cpp11::as_cpp<cpp11::decay_t<int>>(border)));
+  END_CPP11
+}
+// linear.cpp
+SEXP azny_linear_blend(SEXP src, SEXP dst, int mode);
+extern "C" SEXP _aznyan_azny_linear_blend(SEXP src, SEXP dst, SEXP mode) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_linear_blend(cpp11::as_cpp<cpp11::decay_t<SEXP>>(src), cpp11::as_cpp<cpp11::decay_t<SEXP>>(dst), cpp11::as_cpp<cpp11::decay_t<int>>(mode)));
+  END_CPP11
+}
 // lineweave.cpp
 cpp11::integers azny_lineweave(const cpp11::integers& nr, int height, int width, double omega, double phase, int dist1, int dist2, int dist3, bool invert, int direction, const cpp11::integers& fg, const cpp11::integers& bg);
 extern "C" SEXP _aznyan_azny_lineweave(SEXP nr, SEXP height, SEXP width, SEXP omega, SEXP phase, SEXP dist1, SEXP dist2, SEXP dist3, SEXP invert, SEXP direction, SEXP fg, SEXP bg) {
@@ -481,6 +628,13 @@ extern "C" SEXP _aznyan_azny_morphologyrgb(SEXP nr, SEXP height, SEXP width, SEX
     return cpp11::as_sexp(azny_morphologyrgb(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(ksize), cpp11::as_cpp<cpp11::decay_t<int>>(ktype), cpp11::as_cpp<cpp11::decay_t<int>>(mode), cpp11::as_cpp<cpp11::decay_t<int>>(iterations), cpp11::as_cpp<cpp11::decay_t<int>>(border), cpp11::as_cpp<cpp11::decay_t<bool>>(alphasync), cpp11::as_cpp<cpp11::decay_t<cpp11::integers>>(pt)));
   END_CPP11
 }
+// morph.cpp
+cpp11::integers azny_outline(const cpp11::integers& nr, int height, int width, double size, double softness, int position, int color, int threshold);
+extern "C" SEXP _aznyan_azny_outline(SEXP nr, SEXP height, SEXP width, SEXP size, SEXP softness, SEXP position, SEXP color, SEXP threshold) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_outline(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<double>>(size), cpp11::as_cpp<cpp11::decay_t<double>>(softness), cpp11::as_cpp<cpp11::decay_t<int>>(position), cpp11::as_cpp<cpp11::decay_t<int>>(color), cpp11::as_cpp<cpp11::decay_t<int>>(threshold)));
+  END_CPP11
+}
 // others.cpp
 cpp11::integers azny_det_enhance(const cpp11::integers& nr, int height, int width, double sgmS, double sgmR);
 extern "C" SEXP _aznyan_azny_det_enhance(SEXP nr, SEXP height, SEXP width, SEXP sgmS, SEXP sgmR) {
@@ -551,6 +705,41 @@ extern "C" SEXP _aznyan_azny_sort_index(SEXP nr, SEXP height, SEXP width, SEXP m
     return cpp11::as_sexp(azny_sort_index(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(mode), cpp11::as_cpp<cpp11::decay_t<const cpp11::logicals&>>(decending)));
   END_CPP11
 }
+// pixel-positions.cpp
+cpp11::integers azny_pixel_sort(const cpp11::integers& nr, int height, int width, int mode, float lower, float upper, bool vertical, int min_length, bool decreasing);
+extern "C" SEXP _aznyan_azny_pixel_sort(SEXP nr, SEXP height, SEXP width, SEXP mode, SEXP lower, SEXP upper, SEXP vertical, SEXP min_length, SEXP decreasing) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_pixel_sort(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(mode), cpp11::as_cpp<cpp11::decay_t<float>>(lower), cpp11::as_cpp<cpp11::decay_t<float>>(upper), cpp11::as_cpp<cpp11::decay_t<bool>>(vertical), cpp11::as_cpp<cpp11::decay_t<int>>(min_length), cpp11::as_cpp<cpp11::decay_t<bool>>(decreasing)));
+  END_CPP11
+}
+// pixel-positions.cpp
+cpp11::integers azny_pixel_sort_runs(const cpp11::integers& nr, int height, int width, int mode, bool vertical, bool decreasing, const cpp11::integers& group, const cpp11::integers& start, const cpp11::integers& end);
+extern "C" SEXP _aznyan_azny_pixel_sort_runs(SEXP nr, SEXP height, SEXP width, SEXP mode, SEXP vertical, SEXP decreasing, SEXP group, SEXP start, SEXP end) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_pixel_sort_runs(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(mode), cpp11::as_cpp<cpp11::decay_t<bool>>(vertical), cpp11::as_cpp<cpp11::decay_t<bool>>(decreasing), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(group), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(start), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(end)));
+  END_CPP11
+}
+// pixel-positions.cpp
+cpp11::list azny_pixel_runs(const cpp11::integers& nr, int height, int width, int mode, float lower, float upper, bool vertical, int min_length);
+extern "C" SEXP _aznyan_azny_pixel_runs(SEXP nr, SEXP height, SEXP width, SEXP mode, SEXP lower, SEXP upper, SEXP vertical, SEXP min_length) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_pixel_runs(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(mode), cpp11::as_cpp<cpp11::decay_t<float>>(lower), cpp11::as_cpp<cpp11::decay_t<float>>(upper), cpp11::as_cpp<cpp11::decay_t<bool>>(vertical), cpp11::as_cpp<cpp11::decay_t<int>>(min_length)));
+  END_CPP11
+}
+// quantize.cpp
+cpp11::integers azny_quantize_palette(const cpp11::list& frames, const cpp11::integers& heights, const cpp11::integers& widths, int n_colors, int method, int iterations);
+extern "C" SEXP _aznyan_azny_quantize_palette(SEXP frames, SEXP heights, SEXP widths, SEXP n_colors, SEXP method, SEXP iterations) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_quantize_palette(cpp11::as_cpp<cpp11::decay_t<const cpp11::list&>>(frames), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(heights), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(widths), cpp11::as_cpp<cpp11::decay_t<int>>(n_colors), cpp11::as_cpp<cpp11::decay_t<int>>(method), cpp11::as_cpp<cpp11::decay_t<int>>(iterations)));
+  END_CPP11
+}
+// quantize.cpp
+cpp11::list azny_quantize(const cpp11::list& frames, const cpp11::integers& heights, const cpp11::integers& widths, const cpp11::integers& palette);
+extern "C" SEXP _aznyan_azny_quantize(SEXP frames, SEXP heights, SEXP widths, SEXP palette) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_quantize(cpp11::as_cpp<cpp11::decay_t<const cpp11::list&>>(frames), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(heights), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(widths), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(palette)));
+  END_CPP11
+}
 // screen-tone.cpp
 cpp11::integers_matrix<> bayer_mat(const uint8_t& n);
 extern "C" SEXP _aznyan_bayer_mat(SEXP n) {
@@ -559,10 +748,17 @@ extern "C" SEXP _aznyan_bayer_mat(SEXP n) {
   END_CPP11
 }
 // screen-tone.cpp
-cpp11::integers azny_screen_tone(const cpp11::integers& nr, int height, int width, int cutoff, int lift, int bias, const cpp11::integers& pattern);
-extern "C" SEXP _aznyan_azny_screen_tone(SEXP nr, SEXP height, SEXP width, SEXP cutoff, SEXP lift, SEXP bias, SEXP pattern) {
+cpp11::integers azny_screen_tone(const cpp11::integers& nr, int height, int width, int cutoff, int lift, int bias, int levels, const cpp11::integers& pattern);
+extern "C" SEXP _aznyan_azny_screen_tone(SEXP nr, SEXP height, SEXP width, SEXP cutoff, SEXP lift, SEXP bias, SEXP levels, SEXP pattern) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(azny_screen_tone(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(cutoff), cpp11::as_cpp<cpp11::decay_t<int>>(lift), cpp11::as_cpp<cpp11::decay_t<int>>(bias), cpp11::as_cpp<cpp11::decay_t<int>>(levels), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(pattern)));
+  END_CPP11
+}
+// screen-tone.cpp
+cpp11::integers azny_screen_tone_tiled(const cpp11::integers& nr, int height, int width, int cutoff, int lift, int bias, int levels, const cpp11::integers_matrix<>& pattern);
+extern "C" SEXP _aznyan_azny_screen_tone_tiled(SEXP nr, SEXP height, SEXP width, SEXP cutoff, SEXP lift, SEXP bias, SEXP levels, SEXP pattern) {
   BEGIN_CPP11
-    return cpp11::as_sexp(azny_screen_tone(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(cutoff), cpp11::as_cpp<cpp11::decay_t<int>>(lift), cpp11::as_cpp<cpp11::decay_t<int>>(bias), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(pattern)));
+    return cpp11::as_sexp(azny_screen_tone_tiled(cpp11::as_cpp<cpp11::decay_t<const cpp11::integers&>>(nr), cpp11::as_cpp<cpp11::decay_t<int>>(height), cpp11::as_cpp<cpp11::decay_t<int>>(width), cpp11::as_cpp<cpp11::decay_t<int>>(cutoff), cpp11::as_cpp<cpp11::decay_t<int>>(lift), cpp11::as_cpp<cpp11::decay_t<int>>(bias), cpp11::as_cpp<cpp11::decay_t<int>>(levels), cpp11::as_cpp<cpp11::decay_t<const cpp11::integers_matrix<>&>>(pattern)));
   END_CPP11
 }
 // threads.cpp
@@ -596,90 +792,118 @@ extern "C" SEXP _aznyan_azny_adpthres(SEXP nr, SEXP height, SEXP width, SEXP adp
 
 extern "C" {
 static const R_CallMethodDef CallEntries[] = {
-    {"_aznyan_azny_adpthres",          (DL_FUNC) &_aznyan_azny_adpthres,           8},
-    {"_aznyan_azny_bilateral",         (DL_FUNC) &_aznyan_azny_bilateral,          8},
-    {"_aznyan_azny_blend_add",         (DL_FUNC) &_aznyan_azny_blend_add,          4},
-    {"_aznyan_azny_blend_alpha",       (DL_FUNC) &_aznyan_azny_blend_alpha,        4},
-    {"_aznyan_azny_blend_average",     (DL_FUNC) &_aznyan_azny_blend_average,      4},
-    {"_aznyan_azny_blend_colorburn",   (DL_FUNC) &_aznyan_azny_blend_colorburn,    4},
-    {"_aznyan_azny_blend_colordodge",  (DL_FUNC) &_aznyan_azny_blend_colordodge,   4},
-    {"_aznyan_azny_blend_darken",      (DL_FUNC) &_aznyan_azny_blend_darken,       4},
-    {"_aznyan_azny_blend_difference",  (DL_FUNC) &_aznyan_azny_blend_difference,   4},
-    {"_aznyan_azny_blend_divide",      (DL_FUNC) &_aznyan_azny_blend_divide,       4},
-    {"_aznyan_azny_blend_exclusion",   (DL_FUNC) &_aznyan_azny_blend_exclusion,    4},
-    {"_aznyan_azny_blend_ghosting",    (DL_FUNC) &_aznyan_azny_blend_ghosting,     4},
-    {"_aznyan_azny_blend_hardlight",   (DL_FUNC) &_aznyan_azny_blend_hardlight,    4},
-    {"_aznyan_azny_blend_hardmix",     (DL_FUNC) &_aznyan_azny_blend_hardmix,      4},
-    {"_aznyan_azny_blend_lighten",     (DL_FUNC) &_aznyan_azny_blend_lighten,      4},
-    {"_aznyan_azny_blend_linearlight", (DL_FUNC) &_aznyan_azny_blend_linearlight,  4},
-    {"_aznyan_azny_blend_luminosity",  (DL_FUNC) &_aznyan_azny_blend_luminosity,   4},
-    {"_aznyan_azny_blend_multiply",    (DL_FUNC) &_aznyan_azny_blend_multiply,     4},
-    {"_aznyan_azny_blend_overlay",     (DL_FUNC) &_aznyan_azny_blend_overlay,      4},
-    {"_aznyan_azny_blend_pinlight",    (DL_FUNC) &_aznyan_azny_blend_pinlight,     4},
-    {"_aznyan_azny_blend_screen",      (DL_FUNC) &_aznyan_azny_blend_screen,       4},
-    {"_aznyan_azny_blend_softlight",   (DL_FUNC) &_aznyan_azny_blend_softlight,    4},
-    {"_aznyan_azny_blend_subtract",    (DL_FUNC) &_aznyan_azny_blend_subtract,     4},
-    {"_aznyan_azny_blend_vividlight",  (DL_FUNC) &_aznyan_azny_blend_vividlight,   4},
-    {"_aznyan_azny_blurhash",          (DL_FUNC) &_aznyan_azny_blurhash,           5},
-    {"_aznyan_azny_boxblur",           (DL_FUNC) &_aznyan_azny_boxblur,            7},
-    {"_aznyan_azny_brighten",          (DL_FUNC) &_aznyan_azny_brighten,           4},
-    {"_aznyan_azny_cannyfilter",       (DL_FUNC) &_aznyan_azny_cannyfilter,        8},
-    {"_aznyan_azny_cannyrgb",          (DL_FUNC) &_aznyan_azny_cannyrgb,           8},
-    {"_aznyan_azny_color_filter",      (DL_FUNC) &_aznyan_azny_color_filter,       4},
-    {"_aznyan_azny_color_map",         (DL_FUNC) &_aznyan_azny_color_map,          6},
-    {"_aznyan_azny_contrast",          (DL_FUNC) &_aznyan_azny_contrast,           4},
-    {"_aznyan_azny_convolve",          (DL_FUNC) &_aznyan_azny_convolve,           6},
-    {"_aznyan_azny_det_enhance",       (DL_FUNC) &_aznyan_azny_det_enhance,        5},
-    {"_aznyan_azny_diffusion",         (DL_FUNC) &_aznyan_azny_diffusion,          7},
-    {"_aznyan_azny_duotone",           (DL_FUNC) &_aznyan_azny_duotone,            6},
-    {"_aznyan_azny_gaussianblur",      (DL_FUNC) &_aznyan_azny_gaussianblur,       8},
-    {"_aznyan_azny_grayscale",         (DL_FUNC) &_aznyan_azny_grayscale,          3},
-    {"_aznyan_azny_hist_eq",           (DL_FUNC) &_aznyan_azny_hist_eq,            8},
-    {"_aznyan_azny_hue_rotate",        (DL_FUNC) &_aznyan_azny_hue_rotate,         4},
-    {"_aznyan_azny_invert",            (DL_FUNC) &_aznyan_azny_invert,             3},
-    {"_aznyan_azny_kuwahara",          (DL_FUNC) &_aznyan_azny_kuwahara,           7},
-    {"_aznyan_azny_laplacianfilter",   (DL_FUNC) &_aznyan_azny_laplacianfilter,    8},
-    {"_aznyan_azny_laplacianrgb",      (DL_FUNC) &_aznyan_azny_laplacianrgb,       8},
-    {"_aznyan_azny_lineweave",         (DL_FUNC) &_aznyan_azny_lineweave,         12},
-    {"_aznyan_azny_linocut",           (DL_FUNC) &_aznyan_azny_linocut,            6},
-    {"_aznyan_azny_lut1d",             (DL_FUNC) &_aznyan_azny_lut1d,              4},
-    {"_aznyan_azny_lut3d",             (DL_FUNC) &_aznyan_azny_lut3d,              4},
-    {"_aznyan_azny_meanshift",         (DL_FUNC) &_aznyan_azny_meanshift,          6},
-    {"_aznyan_azny_median_cut",        (DL_FUNC) &_aznyan_azny_median_cut,         4},
-    {"_aznyan_azny_medianblur",        (DL_FUNC) &_aznyan_azny_medianblur,         4},
-    {"_aznyan_azny_morphologyfilter",  (DL_FUNC) &_aznyan_azny_morphologyfilter,  10},
-    {"_aznyan_azny_morphologyrgb",     (DL_FUNC) &_aznyan_azny_morphologyrgb,     10},
-    {"_aznyan_azny_oilpaint",          (DL_FUNC) &_aznyan_azny_oilpaint,           5},
-    {"_aznyan_azny_pack_integers",     (DL_FUNC) &_aznyan_azny_pack_integers,      4},
-    {"_aznyan_azny_pencilskc",         (DL_FUNC) &_aznyan_azny_pencilskc,          7},
-    {"_aznyan_azny_pixel_positions",   (DL_FUNC) &_aznyan_azny_pixel_positions,    6},
-    {"_aznyan_azny_posterize",         (DL_FUNC) &_aznyan_azny_posterize,          4},
-    {"_aznyan_azny_preserving",        (DL_FUNC) &_aznyan_azny_preserving,         6},
-    {"_aznyan_azny_read_data",         (DL_FUNC) &_aznyan_azny_read_data,          1},
-    {"_aznyan_azny_read_still",        (DL_FUNC) &_aznyan_azny_read_still,         1},
-    {"_aznyan_azny_resample",          (DL_FUNC) &_aznyan_azny_resample,           6},
-    {"_aznyan_azny_reset_alpha",       (DL_FUNC) &_aznyan_azny_reset_alpha,        4},
-    {"_aznyan_azny_resize",            (DL_FUNC) &_aznyan_azny_resize,             6},
-    {"_aznyan_azny_saturate",          (DL_FUNC) &_aznyan_azny_saturate,           4},
-    {"_aznyan_azny_screen_tone",       (DL_FUNC) &_aznyan_azny_screen_tone,        7},
-    {"_aznyan_azny_sepia",             (DL_FUNC) &_aznyan_azny_sepia,              5},
-    {"_aznyan_azny_set_matte",         (DL_FUNC) &_aznyan_azny_set_matte,          4},
-    {"_aznyan_azny_sobelfilter",       (DL_FUNC) &_aznyan_azny_sobelfilter,       10},
-    {"_aznyan_azny_sobelrgb",          (DL_FUNC) &_aznyan_azny_sobelrgb,          10},
-    {"_aznyan_azny_solarize",          (DL_FUNC) &_aznyan_azny_solarize,           4},
-    {"_aznyan_azny_sort_index",        (DL_FUNC) &_aznyan_azny_sort_index,         5},
-    {"_aznyan_azny_stylize",           (DL_FUNC) &_aznyan_azny_stylize,            5},
-    {"_aznyan_azny_swap_channels",     (DL_FUNC) &_aznyan_azny_swap_channels,      4},
-    {"_aznyan_azny_thres",             (DL_FUNC) &_aznyan_azny_thres,              6},
-    {"_aznyan_azny_unpack_integers",   (DL_FUNC) &_aznyan_azny_unpack_integers,    1},
-    {"_aznyan_azny_unpremul",          (DL_FUNC) &_aznyan_azny_unpremul,           4},
-    {"_aznyan_azny_warp_perspective",  (DL_FUNC) &_aznyan_azny_warp_perspective,   5},
-    {"_aznyan_azny_write_animation",   (DL_FUNC) &_aznyan_azny_write_animation,    5},
-    {"_aznyan_azny_write_data",        (DL_FUNC) &_aznyan_azny_write_data,         5},
-    {"_aznyan_azny_write_still",       (DL_FUNC) &_aznyan_azny_write_still,        4},
-    {"_aznyan_bayer_mat",              (DL_FUNC) &_aznyan_bayer_mat,               1},
-    {"_aznyan_get_num_threads",        (DL_FUNC) &_aznyan_get_num_threads,         0},
-    {"_aznyan_set_num_threads",        (DL_FUNC) &_aznyan_set_num_threads,         1},
+    {"_aznyan_azny_adpthres",            (DL_FUNC) &_aznyan_azny_adpthres,             8},
+    {"_aznyan_azny_animation_close",     (DL_FUNC) &_aznyan_azny_animation_close,      1},
+    {"_aznyan_azny_animation_count",     (DL_FUNC) &_aznyan_azny_animation_count,      1},
+    {"_aznyan_azny_animation_push",      (DL_FUNC) &_aznyan_azny_animation_push,       5},
+    {"_aznyan_azny_animation_read",      (DL_FUNC) &_aznyan_azny_animation_read,       3},
+    {"_aznyan_azny_animation_reader",    (DL_FUNC) &_aznyan_azny_animation_reader,     1},
+    {"_aznyan_azny_animation_writer",    (DL_FUNC) &_aznyan_azny_animation_writer,     3},
+    {"_aznyan_azny_aniso_kuwahara",      (DL_FUNC) &_aznyan_azny_aniso_kuwahara,       9},
+    {"_aznyan_azny_bilateral",           (DL_FUNC) &_aznyan_azny_bilateral,            8},
+    {"_aznyan_azny_bilateralgrid",       (DL_FUNC) &_aznyan_azny_bilateralgrid,        8},
+    {"_aznyan_azny_blend_add",           (DL_FUNC) &_aznyan_azny_blend_add,            4},
+    {"_aznyan_azny_blend_alpha",         (DL_FUNC) &_aznyan_azny_blend_alpha,          4},
+    {"_aznyan_azny_blend_average",       (DL_FUNC) &_aznyan_azny_blend_average,        4},
+    {"_aznyan_azny_blend_colorburn",     (DL_FUNC) &_aznyan_azny_blend_colorburn,      4},
+    {"_aznyan_azny_blend_colordodge",    (DL_FUNC) &_aznyan_azny_blend_colordodge,     4},
+    {"_aznyan_azny_blend_darken",        (DL_FUNC) &_aznyan_azny_blend_darken,         4},
+    {"_aznyan_azny_blend_difference",    (DL_FUNC) &_aznyan_azny_blend_difference,     4},
+    {"_aznyan_azny_blend_divide",        (DL_FUNC) &_aznyan_azny_blend_divide,         4},
+    {"_aznyan_azny_blend_exclusion",     (DL_FUNC) &_aznyan_azny_blend_exclusion,      4},
+    {"_aznyan_azny_blend_ghosting",      (DL_FUNC) &_aznyan_azny_blend_ghosting,       4},
+    {"_aznyan_azny_blend_hardlight",     (DL_FUNC) &_aznyan_azny_blend_hardlight,      4},
+    {"_aznyan_azny_blend_hardmix",       (DL_FUNC) &_aznyan_azny_blend_hardmix,        4},
+    {"_aznyan_azny_blend_lighten",       (DL_FUNC) &_aznyan_azny_blend_lighten,        4},
+    {"_aznyan_azny_blend_linearlight",   (DL_FUNC) &_aznyan_azny_blend_linearlight,    4},
+    {"_aznyan_azny_blend_luminosity",    (DL_FUNC) &_aznyan_azny_blend_luminosity,     4},
+    {"_aznyan_azny_blend_multiply",      (DL_FUNC) &_aznyan_azny_blend_multiply,       4},
+    {"_aznyan_azny_blend_overlay",       (DL_FUNC) &_aznyan_azny_blend_overlay,        4},
+    {"_aznyan_azny_blend_pinlight",      (DL_FUNC) &_aznyan_azny_blend_pinlight,       4},
+    {"_aznyan_azny_blend_screen",        (DL_FUNC) &_aznyan_azny_blend_screen,         4},
+    {"_aznyan_azny_blend_softlight",     (DL_FUNC) &_aznyan_azny_blend_softlight,      4},
+    {"_aznyan_azny_blend_subtract",      (DL_FUNC) &_aznyan_azny_blend_subtract,       4},
+    {"_aznyan_azny_blend_vividlight",    (DL_FUNC) &_aznyan_azny_blend_vividlight,     4},
+    {"_aznyan_azny_bloom",               (DL_FUNC) &_aznyan_azny_bloom,                7},
+    {"_aznyan_azny_blurhash",            (DL_FUNC) &_aznyan_azny_blurhash,             5},
+    {"_aznyan_azny_blurhash_decode",     (DL_FUNC) &_aznyan_azny_blurhash_decode,      4},
+    {"_aznyan_azny_blurhash_encode",     (DL_FUNC) &_aznyan_azny_blurhash_encode,      5},
+    {"_aznyan_azny_boxblur",             (DL_FUNC) &_aznyan_azny_boxblur,              7},
+    {"_aznyan_azny_brighten",            (DL_FUNC) &_aznyan_azny_brighten,             4},
+    {"_aznyan_azny_canny_apply",         (DL_FUNC) &_aznyan_azny_canny_apply,          5},
+    {"_aznyan_azny_canny_gradient",      (DL_FUNC) &_aznyan_azny_canny_gradient,       5},
+    {"_aznyan_azny_cannyfilter",         (DL_FUNC) &_aznyan_azny_cannyfilter,          8},
+    {"_aznyan_azny_cannyrgb",            (DL_FUNC) &_aznyan_azny_cannyrgb,             8},
+    {"_aznyan_azny_color_filter",        (DL_FUNC) &_aznyan_azny_color_filter,         4},
+    {"_aznyan_azny_color_map",           (DL_FUNC) &_aznyan_azny_color_map,            6},
+    {"_aznyan_azny_contrast",            (DL_FUNC) &_aznyan_azny_contrast,             4},
+    {"_aznyan_azny_convolve",            (DL_FUNC) &_aznyan_azny_convolve,             6},
+    {"_aznyan_azny_det_enhance",         (DL_FUNC) &_aznyan_azny_det_enhance,          5},
+    {"_aznyan_azny_diffusion",           (DL_FUNC) &_aznyan_azny_diffusion,            8},
+    {"_aznyan_azny_dither",              (DL_FUNC) &_aznyan_azny_dither,               5},
+    {"_aznyan_azny_duotone",             (DL_FUNC) &_aznyan_azny_duotone,              6},
+    {"_aznyan_azny_gaussianblur",        (DL_FUNC) &_aznyan_azny_gaussianblur,         8},
+    {"_aznyan_azny_grayscale",           (DL_FUNC) &_aznyan_azny_grayscale,            3},
+    {"_aznyan_azny_hist_eq",             (DL_FUNC) &_aznyan_azny_hist_eq,              8},
+    {"_aznyan_azny_hue_rotate",          (DL_FUNC) &_aznyan_azny_hue_rotate,           4},
+    {"_aznyan_azny_invert",              (DL_FUNC) &_aznyan_azny_invert,               3},
+    {"_aznyan_azny_kuwahara",            (DL_FUNC) &_aznyan_azny_kuwahara,             7},
+    {"_aznyan_azny_laplacianfilter",     (DL_FUNC) &_aznyan_azny_laplacianfilter,      8},
+    {"_aznyan_azny_laplacianrgb",        (DL_FUNC) &_aznyan_azny_laplacianrgb,         8},
+    {"_aznyan_azny_linear_blend",        (DL_FUNC) &_aznyan_azny_linear_blend,         3},
+    {"_aznyan_azny_linear_boxblur",      (DL_FUNC) &_aznyan_azny_linear_boxblur,       5},
+    {"_aznyan_azny_linear_decode",       (DL_FUNC) &_aznyan_azny_linear_decode,        3},
+    {"_aznyan_azny_linear_dim",          (DL_FUNC) &_aznyan_azny_linear_dim,           1},
+    {"_aznyan_azny_linear_encode",       (DL_FUNC) &_aznyan_azny_linear_encode,        1},
+    {"_aznyan_azny_linear_gaussianblur", (DL_FUNC) &_aznyan_azny_linear_gaussianblur,  6},
+    {"_aznyan_azny_lineweave",           (DL_FUNC) &_aznyan_azny_lineweave,           12},
+    {"_aznyan_azny_linocut",             (DL_FUNC) &_aznyan_azny_linocut,              6},
+    {"_aznyan_azny_lut1d",               (DL_FUNC) &_aznyan_azny_lut1d,                4},
+    {"_aznyan_azny_lut3d",               (DL_FUNC) &_aznyan_azny_lut3d,                4},
+    {"_aznyan_azny_meanshift",           (DL_FUNC) &_aznyan_azny_meanshift,            6},
+    {"_aznyan_azny_median_cut",          (DL_FUNC) &_aznyan_azny_median_cut,           4},
+    {"_aznyan_azny_medianblur",          (DL_FUNC) &_aznyan_azny_medianblur,           4},
+    {"_aznyan_azny_morphologyfilter",    (DL_FUNC) &_aznyan_azny_morphologyfilter,    10},
+    {"_aznyan_azny_morphologyrgb",       (DL_FUNC) &_aznyan_azny_morphologyrgb,       10},
+    {"_aznyan_azny_oilpaint",            (DL_FUNC) &_aznyan_azny_oilpaint,             5},
+    {"_aznyan_azny_outline",             (DL_FUNC) &_aznyan_azny_outline,              8},
+    {"_aznyan_azny_pack_integers",       (DL_FUNC) &_aznyan_azny_pack_integers,        4},
+    {"_aznyan_azny_pencilskc",           (DL_FUNC) &_aznyan_azny_pencilskc,            7},
+    {"_aznyan_azny_pixel_positions",     (DL_FUNC) &_aznyan_azny_pixel_positions,      6},
+    {"_aznyan_azny_pixel_runs",          (DL_FUNC) &_aznyan_azny_pixel_runs,           8},
+    {"_aznyan_azny_pixel_sort",          (DL_FUNC) &_aznyan_azny_pixel_sort,           9},
+    {"_aznyan_azny_pixel_sort_runs",     (DL_FUNC) &_aznyan_azny_pixel_sort_runs,      9},
+    {"_aznyan_azny_posterize",           (DL_FUNC) &_aznyan_azny_posterize,            4},
+    {"_aznyan_azny_preserving",          (DL_FUNC) &_aznyan_azny_preserving,           6},
+    {"_aznyan_azny_quantize",            (DL_FUNC) &_aznyan_azny_quantize,             4},
+    {"_aznyan_azny_quantize_palette",    (DL_FUNC) &_aznyan_azny_quantize_palette,     6},
+    {"_aznyan_azny_read_data",           (DL_FUNC) &_aznyan_azny_read_data,            1},
+    {"_aznyan_azny_read_still",          (DL_FUNC) &_aznyan_azny_read_still,           1},
+    {"_aznyan_azny_resample",            (DL_FUNC) &_aznyan_azny_resample,             6},
+    {"_aznyan_azny_reset_alpha",         (DL_FUNC) &_aznyan_azny_reset_alpha,          4},
+    {"_aznyan_azny_resize",              (DL_FUNC) &_aznyan_azny_resize,               6},
+    {"_aznyan_azny_saturate",            (DL_FUNC) &_aznyan_azny_saturate,             4},
+    {"_aznyan_azny_screen_tone",         (DL_FUNC) &_aznyan_azny_screen_tone,          8},
+    {"_aznyan_azny_screen_tone_tiled",   (DL_FUNC) &_aznyan_azny_screen_tone_tiled,    8},
+    {"_aznyan_azny_sepia",               (DL_FUNC) &_aznyan_azny_sepia,                5},
+    {"_aznyan_azny_set_matte",           (DL_FUNC) &_aznyan_azny_set_matte,            4},
+    {"_aznyan_azny_sobel_gradient",      (DL_FUNC) &_aznyan_azny_sobel_gradient,       7},
+    {"_aznyan_azny_sobelfilter",         (DL_FUNC) &_aznyan_azny_sobelfilter,         10},
+    {"_aznyan_azny_sobelrgb",            (DL_FUNC) &_aznyan_azny_sobelrgb,            10},
+    {"_aznyan_azny_solarize",            (DL_FUNC) &_aznyan_azny_solarize,             4},
+    {"_aznyan_azny_sort_index",          (DL_FUNC) &_aznyan_azny_sort_index,           5},
+    {"_aznyan_azny_stylize",             (DL_FUNC) &_aznyan_azny_stylize,              5},
+    {"_aznyan_azny_swap_channels",       (DL_FUNC) &_aznyan_azny_swap_channels,        4},
+    {"_aznyan_azny_thres",               (DL_FUNC) &_aznyan_azny_thres,                6},
+    {"_aznyan_azny_unpack_integers",     (DL_FUNC) &_aznyan_azny_unpack_integers,      1},
+    {"_aznyan_azny_unpremul",            (DL_FUNC) &_aznyan_azny_unpremul,             4},
+    {"_aznyan_azny_warp_perspective",    (DL_FUNC) &_aznyan_azny_warp_perspective,     5},
+    {"_aznyan_azny_write_animation",     (DL_FUNC) &_aznyan_azny_write_animation,      5},
+    {"_aznyan_azny_write_data",          (DL_FUNC) &_aznyan_azny_write_data,           5},
+    {"_aznyan_azny_write_still",         (DL_FUNC) &_aznyan_azny_write_still,          4},
+    {"_aznyan_bayer_mat",                (DL_FUNC) &_aznyan_bayer_mat,                 1},
+    {"_aznyan_get_num_threads",          (DL_FUNC) &_aznyan_get_num_threads,           0},
+    {"_aznyan_set_num_threads",          (DL_FUNC) &_aznyan_set_num_threads,           1},
     {NULL, NULL, 0}
 };
 }
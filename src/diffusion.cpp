@@ -1,30 +1,75 @@
-#include "aznyan_types.h"
+#include "aznyan_color.h"
+
+namespace {
+
+// Blurs up to this standard deviation run at full resolution.
+constexpr double kFullSigma = 16.0;
+// Pyramid levels are not built below this size.
+constexpr int kMinLevelSize = 16;
+
+/**
+ * Gaussian blur of `pyr[0]`. Wider blurs run on the coarsest level of the
+ * Gaussian pyramid at which the standard deviation stays within
+ * kFullSigma, and are brought back up with pyrUp(). Levels are built on
+ * demand and kept in `pyr` for later calls.
+ */
+cv::Mat pyramid_blur(std::vector<cv::Mat>& pyr, double sigma) {
+  size_t l = 0;
+  while (std::ldexp(sigma, -static_cast<int>(l)) > kFullSigma &&
+         std::min(pyr[l].rows, pyr[l].cols) >= 2 * kMinLevelSize) {
+    if (l + 1 == pyr.size()) {
+      cv::Mat down;
+      cv::pyrDown(pyr[l], down);
+      pyr.push_back(down);
+    }
+    ++l;
+  }
+  // Beyond the size of the level the blur is flat anyway.
+  const double s = std::min(std::ldexp(sigma, -static_cast<int>(l)),
+                            static_cast<double>(std::max(pyr[l].rows,
+                                                         pyr[l].cols)));
+  cv::Mat blurred;
+  cv::GaussianBlur(pyr[l], blurred, cv::Size(), s);
+  // pyrUp() keeps each level aligned with the finer one, which resize()
+  // would shift by half a coarse pixel per level.
+  for (size_t k = l; k-- > 0;) {
+    cv::Mat up;
+    cv::pyrUp(blurred, up, pyr[k].size());
+    blurred = up;
+  }
+  return blurred;
+}
+
+}  // namespace
 
 [[cpp11::register]]
 cpp11::integers azny_diffusion(const cpp11::integers& nr, int height, int width,
-                               double decay_factor,
-                               double decay_offset, double gamma, int sigma) {
+                               double decay_factor, double decay_offset,
+                               double gamma, int sigma, int iterations) {
+  if (gamma <= 0) {
+    cpp11::stop("gamma must be greater than 0.");
+  }
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
-  cv::Mat tmpB;
-  bgra[0].convertTo(tmpB, CV_32FC3, 1.0f / 255.0f);
 
-  cv::Mat tmpC = cv::Mat::zeros(tmpB.size(), CV_32FC3);
+  // Gamma is applied through a table of the 8-bit levels, and undone by
+  // searching for the output level, so there is no pow() per sample.
+  const std::array<float, 256> lut = aznyan::power_lut(gamma);
+  cv::Mat tmpC(bgra[0].size(), CV_32FC3);
   aznyan::parallel_for(0, height, [&](int y) {
-    cv::Vec3f* pIN = tmpB.ptr<cv::Vec3f>(y);
+    const cv::Vec3b* pIN = bgra[0].ptr<cv::Vec3b>(y);
     cv::Vec3f* pPOW = tmpC.ptr<cv::Vec3f>(y);
     for (int x = 0; x < width; ++x) {
-      pPOW[x][0] = std::pow(pIN[x][0], gamma);
-      pPOW[x][1] = std::pow(pIN[x][1], gamma);
-      pPOW[x][2] = std::pow(pIN[x][2], gamma);
+      pPOW[x] = cv::Vec3f(lut[pIN[x][0]], lut[pIN[x][1]], lut[pIN[x][2]]);
     }
   });
 
   cv::Mat tmpE = tmpC.clone();
-  for (int i = 0; i < 2; ++i) {
+  std::vector<cv::Mat> pyr{tmpC};
+  double s = sigma;
+  for (int i = 0; i < iterations; ++i) {
     const float gain = std::pow(decay_factor, -((float)i + decay_offset));
-    sigma *= sigma;
-    cv::Mat tmpD;
-    cv::GaussianBlur(tmpC, tmpD, cv::Size(), (double)sigma);
+    s *= s;
+    cv::Mat tmpD = pyramid_blur(pyr, s);
 
     aznyan::parallel_for(0, height, [&tmpD, &tmpE, gain, width](int y) {
       cv::Vec3f* pIN1 = tmpD.ptr<cv::Vec3f>(y);
@@ -39,19 +84,68 @@ cpp11::integers azny_diffusion(const cpp11::integers& nr, int height, int width,
     cpp11::check_user_interrupt();
   }
 
-  const float gm_inv = 1.0f / gamma;
-  cv::Mat tmpF = cv::Mat::zeros(tmpB.size(), CV_32FC3);
-  aznyan::parallel_for(0, height, [&tmpE, &tmpF, gm_inv, width](int y) {
-    cv::Vec3f* pIN3 = tmpE.ptr<cv::Vec3f>(y);
-    cv::Vec3f* pOUT = tmpF.ptr<cv::Vec3f>(y);
+  const aznyan::ByteEncoder enc(
+      [gamma](float v) { return std::pow(v, gamma); }, .5f);
+  cv::Mat out(tmpE.size(), CV_8UC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const cv::Vec3f* pIN3 = tmpE.ptr<cv::Vec3f>(y);
+    cv::Vec3b* pOUT = out.ptr<cv::Vec3b>(y);
     for (int x = 0; x < width; ++x) {
-      pOUT[x][0] = std::clamp(std::pow(pIN3[x][0], gm_inv), 0.f, 1.f);
-      pOUT[x][1] = std::clamp(std::pow(pIN3[x][1], gm_inv), 0.f, 1.f);
-      pOUT[x][2] = std::clamp(std::pow(pIN3[x][2], gm_inv), 0.f, 1.f);
+      pOUT[x] = cv::Vec3b(enc(pIN3[x][0]), enc(pIN3[x][1]), enc(pIN3[x][2]));
     }
   });
-
-  cv::Mat out;
-  convertScaleAbs(tmpF, out, 255.0f, 0.0f);
   return aznyan::encode_nr(out, bgra[1]);
 }
+
+/**
+ * Bloom in linear light. The part of each pixel above `threshold` is
+ * reduced down a Gaussian pyramid, whose levels are blurred by pyrDown()
+ * itself, and the levels are then summed back up from the coarsest one
+ * with weights falling off by `falloff` per level.
+ */
+[[cpp11::register]]
+cpp11::integers azny_bloom(const cpp11::integers& nr, int height, int width,
+                           double threshold, double intensity, int levels,
+                           double falloff) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  const cv::Mat lin = aznyan::decode_linear(bgra[0]);
+
+  const float knee = static_cast<float>(threshold);
+  cv::Mat bright(lin.size(), CV_32FC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const cv::Vec3f* pIN = lin.ptr<cv::Vec3f>(y);
+    cv::Vec3f* pOUT = bright.ptr<cv::Vec3f>(y);
+    for (int x = 0; x < width; ++x) {
+      const float lum = 0.0722f * pIN[x][0] + 0.7152f * pIN[x][1] +
+                        0.2126f * pIN[x][2];
+      const float over = std::max(lum - knee, 0.0f);
+      pOUT[x] = lum > 0.0f ? pIN[x] * (over / lum) : cv::Vec3f(0, 0, 0);
+    }
+  });
+
+  std::vector<cv::Mat> pyr{bright};
+  while (static_cast<int>(pyr.size()) < levels &&
+         std::min(pyr.back().rows, pyr.back().cols) >= 2 * kMinLevelSize) {
+    cv::Mat down;
+    cv::pyrDown(pyr.back(), down);
+    pyr.push_back(down);
+  }
+  const int n = static_cast<int>(pyr.size());
+  std::vector<double> weight(n);
+  double total = 0.0;
+  for (int l = 0; l < n; ++l) {
+    weight[l] = std::pow(falloff, l);
+    total += weight[l];
+  }
+
+  cv::Mat acc = pyr[n - 1] * (weight[n - 1] / total);
+  for (int l = n - 2; l >= 0; --l) {
+    cv::Mat up;
+    cv::pyrUp(acc, up, pyr[l].size());
+    cv::scaleAdd(pyr[l], weight[l] / total, up, acc);
+    cpp11::check_user_interrupt();
+  }
+  cv::scaleAdd(acc, intensity, lin, acc);
+
+  return aznyan::encode_nr(aznyan::encode_linear(acc), bgra[1]);
+}
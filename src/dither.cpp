@@ -0,0 +1,142 @@
+#include "aznyan_quantize.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+
+struct DiffusionTap {
+  int dx;
+  int dy;
+  float weight;
+};
+
+/**
+ * Error-diffusion kernel. `reach` is the largest |dx| of the taps that
+ * push error into later rows.
+ */
+struct DiffusionKernel {
+  std::vector<DiffusionTap> taps;
+  int rows;
+  int reach;
+};
+
+DiffusionKernel diffusion_kernel(int method) {
+  std::vector<std::array<int, 3>> taps;
+  float divisor = 1.f;
+  switch (method) {
+    case 1:  // Atkinson; only 6/8 of the error is passed on
+      taps = {{1, 0, 1}, {2, 0, 1}, {-1, 1, 1},
+              {0, 1, 1}, {1, 1, 1}, {0, 2, 1}};
+      divisor = 8.f;
+      break;
+    case 2:  // Jarvis, Judice and Ninke
+      taps = {{1, 0, 7},  {2, 0, 5},  {-2, 1, 3}, {-1, 1, 5}, {0, 1, 7},
+              {1, 1, 5},  {2, 1, 3},  {-2, 2, 1}, {-1, 2, 3}, {0, 2, 5},
+              {1, 2, 3},  {2, 2, 1}};
+      divisor = 48.f;
+      break;
+    case 3:  // Sierra
+      taps = {{1, 0, 5},  {2, 0, 3}, {-2, 1, 2}, {-1, 1, 4}, {0, 1, 5},
+              {1, 1, 4},  {2, 1, 2}, {-1, 2, 2}, {0, 2, 3},  {1, 2, 2}};
+      divisor = 32.f;
+      break;
+    default:  // Floyd-Steinberg
+      taps = {{1, 0, 7}, {-1, 1, 3}, {0, 1, 5}, {1, 1, 1}};
+      divisor = 16.f;
+      break;
+  }
+  DiffusionKernel kernel{{}, 0, 0};
+  for (const auto& [dx, dy, w] : taps) {
+    kernel.taps.push_back(DiffusionTap{dx, dy, w / divisor});
+    kernel.rows = std::max(kernel.rows, dy);
+    if (dy > 0) kernel.reach = std::max(kernel.reach, std::abs(dx));
+  }
+  return kernel;
+}
+
+}  // namespace
+
+/**
+ * Error diffusion is serial along the scan order, but row y only needs the
+ * part of row y - 1 that can still push error into it. Rows are therefore
+ * handed to workers round-robin, and each worker trails the row above by
+ * `lag` pixels, which forms a diagonal wavefront across the image.
+ *
+ * A lag of 2 * reach + 1 also keeps the writes of two consecutive rows into
+ * a later row apart, so no two workers touch the same error value. Error
+ * for the current row is carried in a local buffer; error for later rows
+ * lives in a ring of `rows + 1` row buffers, which a row clears as it
+ * reads them.
+ */
+[[cpp11::register]]
+cpp11::integers azny_dither(const cpp11::integers& nr, int height, int width,
+                            const cpp11::integers& palette, int method) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+
+  std::vector<cv::Vec3b> colors(palette.size());
+  for (R_xlen_t i = 0; i < palette.size(); ++i) {
+    const auto [r, g, b, a] = aznyan::int_to_rgba(palette[i]);
+    colors[i] = cv::Vec3b(b, g, r);
+  }
+  const aznyan::InverseColormap lookup(colors);
+  const DiffusionKernel kernel = diffusion_kernel(method);
+
+  const int lag = 2 * kernel.reach + 1;
+  const int ring = kernel.rows + 1;
+  std::vector<std::vector<float>> pending(ring,
+                                          std::vector<float>(width * 3, 0.f));
+  std::vector<std::atomic<int>> progress(height);
+  for (auto& p : progress) p.store(0, std::memory_order_relaxed);
+
+  const cv::Mat& src = bgra[0];
+  cv::Mat out(src.size(), CV_8UC3);
+
+  auto run_row = [&](int y, std::vector<float>& carry) {
+    std::fill(carry.begin(), carry.end(), 0.f);
+    std::vector<float>& own = pending[y % ring];
+    const cv::Vec3b* src_row = src.ptr<cv::Vec3b>(y);
+    cv::Vec3b* dst_row = out.ptr<cv::Vec3b>(y);
+    int above = y > 0 ? 0 : width;
+    for (int x = 0; x < width; ++x) {
+      const int need = std::min(width, x + lag);
+      while (above < need) {
+        above = progress[y - 1].load(std::memory_order_acquire);
+        if (above < need) std::this_thread::yield();
+      }
+      float v[3];
+      int q[3];
+      for (int c = 0; c < 3; ++c) {
+        v[c] = clampf(src_row[x][c] + own[x * 3 + c] + carry[x * 3 + c], 0.f,
+                      255.f);
+        own[x * 3 + c] = 0.f;
+        q[c] = static_cast<int>(std::lround(v[c]));
+      }
+      const cv::Vec3b& chosen = colors[lookup(q[0], q[1], q[2])];
+      dst_row[x] = chosen;
+      for (const auto& tap : kernel.taps) {
+        const int tx = x + tap.dx, ty = y + tap.dy;
+        if (tx < 0 || tx >= width || ty >= height) continue;
+        float* dst =
+            tap.dy == 0 ? &carry[tx * 3] : &pending[ty % ring][tx * 3];
+        for (int c = 0; c < 3; ++c) {
+          dst[c] += (v[c] - chosen[c]) * tap.weight;
+        }
+      }
+      progress[y].store(x + 1, std::memory_order_release);
+    }
+  };
+
+  const int nthreads = std::clamp(cv::getNumThreads(), 1, height);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < nthreads; ++t) {
+    workers.emplace_back([&, t]() {
+      std::vector<float> carry(width * 3, 0.f);
+      for (int y = t; y < height; y += nthreads) {
+        run_row(y, carry);
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  return aznyan::encode_nr(out, bgra[1]);
+}
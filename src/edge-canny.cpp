@@ -1,5 +1,32 @@
 #include "aznyan_types.h"
 
+namespace {
+
+/**
+ * Sobel derivatives cached for repeated Canny calls with different
+ * thresholds. Holds one (dx, dy) pair per channel, computed the way
+ * cv::Canny computes them internally.
+ */
+struct CannyGradient {
+  int aperture;
+  std::vector<cv::Mat> dx;
+  std::vector<cv::Mat> dy;
+  cv::Mat alpha;
+};
+
+void canny_from_gradient(const CannyGradient& grad, int i, cv::Mat& edges,
+                         double thres1, double thres2, bool gradient) {
+  // cv::Canny scales thresholds down for the 7x7 aperture only when it
+  // computes the derivatives itself.
+  if (grad.aperture == 7) {
+    thres1 /= 16.0;
+    thres2 /= 16.0;
+  }
+  cv::Canny(grad.dx[i], grad.dy[i], edges, thres1, thres2, gradient);
+}
+
+}  // namespace
+
 [[cpp11::register]]
 cpp11::integers azny_cannyfilter(const cpp11::integers& nr, int height,
                                  int width, int asize, bool balp, bool gradient,
@@ -28,11 +55,13 @@ cpp11::integers azny_cannyrgb(const cpp11::integers& nr, int height, int width,
   cv::split(bgra[0], ch_col);
   ch_col.push_back(bgra[1]);
 
+  std::vector<cv::Mat> edges(3);
+  aznyan::parallel_for(0, 3, [&](int i) {
+    cv::Canny(ch_col[i], edges[i], thres1, thres2, 2 * asize - 1, gradient);
+  });
   cv::Mat tmpB = cv::Mat::zeros(bgra[0].size(), CV_8U);
   for (int i = 0; i < 3; ++i) {
-    cv::Mat tmpC;
-    cv::Canny(ch_col[i], tmpC, thres1, thres2, 2 * asize - 1, gradient);
-    cv::add(tmpB, tmpC, tmpB);
+    cv::add(tmpB, edges[i], tmpB);
   }
   if (balp) {
     cv::threshold(tmpB, ch_col[3], 0.1, 255, cv::THRESH_BINARY);
@@ -41,3 +70,58 @@ cpp11::integers azny_cannyrgb(const cpp11::integers& nr, int height, int width,
   cv::merge(std::vector<cv::Mat>{tmpB, tmpB, tmpB}, out);
   return aznyan::encode_nr(out, ch_col[3]);
 }
+
+[[cpp11::register]]
+SEXP azny_canny_gradient(const cpp11::integers& nr, int height, int width,
+                         int asize, bool use_rgb) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+
+  cv::Mat src, dx, dy;
+  if (use_rgb) {
+    src = bgra[0];
+  } else {
+    cv::cvtColor(bgra[0], src, cv::COLOR_BGRA2GRAY);
+  }
+  const int aperture = 2 * asize - 1;
+  cv::Sobel(src, dx, CV_16S, 1, 0, aperture, 1, 0, cv::BORDER_REPLICATE);
+  cv::Sobel(src, dy, CV_16S, 0, 1, aperture, 1, 0, cv::BORDER_REPLICATE);
+
+  auto* grad = new CannyGradient{aperture, {}, {}, bgra[1]};
+  cv::split(dx, grad->dx);
+  cv::split(dy, grad->dy);
+
+  cpp11::external_pointer<CannyGradient> ptr(grad);
+  return ptr;
+}
+
+[[cpp11::register]]
+cpp11::integers azny_canny_apply(SEXP handle, bool balp, bool gradient,
+                                 double thres1, double thres2) {
+  cpp11::external_pointer<CannyGradient> ptr(handle);
+  if (ptr.get() == nullptr) {
+    cpp11::stop("Invalid Canny gradient handle.");
+  }
+  const CannyGradient& grad = *ptr;
+  const int n = static_cast<int>(grad.dx.size());
+
+  // Only non-maximum suppression and hysteresis run here.
+  std::vector<cv::Mat> edges(n);
+  aznyan::parallel_for(0, n, [&](int i) {
+    canny_from_gradient(grad, i, edges[i], thres1, thres2, gradient);
+  });
+  cv::Mat tmpB = edges[0];
+  for (int i = 1; i < n; ++i) {
+    cv::add(tmpB, edges[i], tmpB);
+  }
+  // Threshold into a fresh Mat so the alpha kept in the handle is not
+  // overwritten.
+  cv::Mat alpha;
+  if (balp) {
+    cv::threshold(tmpB, alpha, 0.1, 255, cv::THRESH_BINARY);
+  } else {
+    alpha = grad.alpha;
+  }
+  cv::Mat out;
+  cv::merge(std::vector<cv::Mat>{tmpB, tmpB, tmpB}, out);
+  return aznyan::encode_nr(out, alpha);
+}
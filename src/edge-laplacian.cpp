@@ -1,4 +1,4 @@
-#include "aznyan_types.h"
+#include "aznyan_edge.h"
 
 [[cpp11::register]]
 cpp11::integers azny_laplacianfilter(const cpp11::integers& nr, int height,
@@ -6,17 +6,17 @@ cpp11::integers azny_laplacianfilter(const cpp11::integers& nr, int height,
                                      int border, double scale, double delta) {
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
 
-  cv::Mat tmpB, tmpC, tmpD, tmpE;
+  cv::Mat tmpB, tmpE;
   cv::cvtColor(bgra[0], tmpB, cv::COLOR_BGR2GRAY);
-  tmpB.convertTo(tmpC, CV_32FC3, 1.0 / 255.0, 0.0);
 
   ksize = std::max(2 * ksize - 1, 0);
-  cv::Laplacian(tmpC, tmpD, -1, ksize, scale, delta, aznyan::mode_a[border]);
-  cv::convertScaleAbs(tmpD, tmpE, 255.0, 0.0);
+  aznyan::edge_response(
+      tmpB, tmpE, bgra[1], balp, aznyan::mode_a[border],
+      [&](const cv::Mat& src, cv::Mat& dst) {
+        cv::Laplacian(src, dst, CV_32F, ksize, scale / 255.0, delta,
+                      aznyan::mode_a[border]);
+      });
 
-  if (balp) {
-    cv::threshold(tmpE, bgra[1], 0.1, 255, cv::THRESH_BINARY);
-  }
   cv::Mat out;
   cv::merge(std::vector<cv::Mat>{tmpE, tmpE, tmpE}, out);
   return aznyan::encode_nr(out, bgra[1]);
@@ -27,31 +27,17 @@ cpp11::integers azny_laplacianrgb(const cpp11::integers& nr, int height,
                                   int width, int ksize, bool balp, int border,
                                   double scale, double delta) {
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
-  bgra[0].convertTo(bgra[0], CV_32FC4, 1.0 / 255, 0.0);
-  bgra[1].convertTo(bgra[1], CV_32FC1, 1.0 / 255, 0.0);
-
-  std::vector<cv::Mat> ch_col;
-  cv::split(bgra[0], ch_col);
-  ch_col.push_back(bgra[1]);
 
   ksize = std::max(2 * ksize - 1, 0);
+  cv::Mat tmpD;
+  aznyan::edge_response(
+      bgra[0], tmpD, bgra[1], balp, aznyan::mode_a[border],
+      [&](const cv::Mat& src, cv::Mat& dst) {
+        cv::Laplacian(src, dst, CV_32F, ksize, scale / 255.0, delta,
+                      aznyan::mode_a[border]);
+      });
 
-  cv::Mat tmpC = cv::Mat::zeros(bgra[0].size(), CV_32F);
-  cv::Mat tmpD, tmpF;
-  for (int i = 0; i < 3; ++i) {
-    cv::Mat tmpE;
-    cv::Laplacian(ch_col[i], tmpE, -1, ksize, scale, delta,
-                  aznyan::mode_a[border]);
-    cv::add(tmpC, tmpE, tmpC);
-  }
-  cv::convertScaleAbs(tmpC, tmpD, 255.0, 0.0);
-
-  if (balp) {
-    cv::threshold(tmpD, tmpF, 0.1, 255, cv::THRESH_BINARY);
-  } else {
-    cv::convertScaleAbs(ch_col[3], tmpF, 255.0, 0.0);
-  }
   cv::Mat out;
   cv::merge(std::vector<cv::Mat>{tmpD, tmpD, tmpD}, out);
-  return aznyan::encode_nr(out, tmpF);
+  return aznyan::encode_nr(out, bgra[1]);
 }
@@ -1,4 +1,4 @@
-#include "aznyan_types.h"
+#include "aznyan_edge.h"
 
 [[cpp11::register]]
 cpp11::integers azny_sobelfilter(const cpp11::integers& nr, int height,
@@ -7,16 +7,16 @@ cpp11::integers azny_sobelfilter(const cpp11::integers& nr, int height,
                                  double delta) {
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
 
-  cv::Mat tmpB, tmpC, tmpD, tmpE;
+  cv::Mat tmpB, tmpE;
   cv::cvtColor(bgra[0], tmpB, cv::COLOR_BGR2GRAY);
-  tmpB.convertTo(tmpC, CV_32FC3, 1.0 / 255, 0.0);
 
   ksize = std::max(2 * ksize - 1, 0);
-  cv::Sobel(tmpC, tmpD, -1, dx, dy, ksize, scale, delta,
-            aznyan::mode_a[border]);
-  cv::convertScaleAbs(tmpD, tmpE, 255.0, 0.0);
-
-  if (balp) cv::threshold(tmpE, bgra[1], 0.1, 255, cv::THRESH_BINARY);
+  aznyan::edge_response(
+      tmpB, tmpE, bgra[1], balp, aznyan::mode_a[border],
+      [&](const cv::Mat& src, cv::Mat& dst) {
+        cv::Sobel(src, dst, CV_32F, dx, dy, ksize, scale / 255.0, delta,
+                  aznyan::mode_a[border]);
+      });
 
   cv::Mat out;
   cv::merge(std::vector<cv::Mat>{tmpE, tmpE, tmpE}, out);
@@ -28,31 +28,65 @@ cpp11::integers azny_sobelrgb(const cpp11::integers& nr, int height, int width,
                               int ksize, bool balp, int dx, int dy, int border,
                               double scale, double delta) {
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
-  bgra[0].convertTo(bgra[0], CV_32FC4, 1.0 / 255, 0.0);
-  bgra[1].convertTo(bgra[1], CV_32FC1, 1.0 / 255, 0.0);
-
-  std::vector<cv::Mat> ch_col;
-  cv::split(bgra[0], ch_col);
-  ch_col.push_back(bgra[1]);
 
   ksize = std::max(2 * ksize - 1, 0);
+  cv::Mat tmpD;
+  aznyan::edge_response(
+      bgra[0], tmpD, bgra[1], balp, aznyan::mode_a[border],
+      [&](const cv::Mat& src, cv::Mat& dst) {
+        cv::Sobel(src, dst, CV_32F, dx, dy, ksize, scale / 255.0, delta,
+                  aznyan::mode_a[border]);
+      });
 
-  cv::Mat tmpC = cv::Mat::zeros(bgra[0].size(), CV_32F);
-  cv::Mat tmpD, tmpF;
-  for (int i = 0; i < 3; ++i) {
-    cv::Mat tmpE;
-    cv::Sobel(ch_col[i], tmpE, -1, dx, dy, ksize, scale, delta,
-              aznyan::mode_a[border]);
-    cv::add(tmpC, tmpE, tmpC);
-  }
-  cv::convertScaleAbs(tmpC, tmpD, 255.0, 0.0);
-
-  if (balp) {
-    cv::threshold(tmpD, tmpF, 0.1, 255, cv::THRESH_BINARY);
-  } else {
-    cv::convertScaleAbs(ch_col[3], tmpF, 255.0, 0.0);
-  }
   cv::Mat out;
   cv::merge(std::vector<cv::Mat>{tmpD, tmpD, tmpD}, out);
-  return aznyan::encode_nr(out, tmpF);
+  return aznyan::encode_nr(out, bgra[1]);
+}
+
+[[cpp11::register]]
+cpp11::list azny_sobel_gradient(const cpp11::integers& nr, int height,
+                                int width, int ksize, int border, double scale,
+                                bool orientation) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  ksize = std::max(2 * ksize - 1, 1);
+
+  // Magnitude is the norm over all channels. Orientation is taken from the
+  // summed structure tensor (Di Zenzo), so that channels with opposite
+  // gradients do not cancel out. Both are written column-major.
+  cpp11::writable::doubles mag(static_cast<R_xlen_t>(height) * width);
+  cpp11::writable::doubles ori(orientation ? mag.size() : 0);
+  double* pmag = REAL(mag);
+  double* pori = orientation ? REAL(ori) : nullptr;
+  aznyan::edge_bands(height, aznyan::mode_a[border], [&](int y0, int y1) {
+    cv::Mat gx, gy;
+    const cv::Mat src = bgra[0].rowRange(y0, y1);
+    cv::Sobel(src, gx, CV_32F, 1, 0, ksize, scale / 255.0, 0.0,
+              aznyan::mode_a[border]);
+    cv::Sobel(src, gy, CV_32F, 0, 1, ksize, scale / 255.0, 0.0,
+              aznyan::mode_a[border]);
+    for (int y = y0; y < y1; y++) {
+      const float* px = gx.ptr<float>(y - y0);
+      const float* py = gy.ptr<float>(y - y0);
+      for (int x = 0; x < width; x++) {
+        float xx = 0.0f, yy = 0.0f, xy = 0.0f;
+        for (int c = 0; c < 3; c++) {
+          const float u = px[x * 3 + c];
+          const float v = py[x * 3 + c];
+          xx += u * u;
+          yy += v * v;
+          xy += u * v;
+        }
+        const R_xlen_t i = static_cast<R_xlen_t>(x) * height + y;
+        pmag[i] = std::sqrt(xx + yy);
+        if (pori) pori[i] = 0.5 * std::atan2(2.0 * xy, xx - yy);
+      }
+    }
+  });
+  mag.attr("dim") = cpp11::as_sexp({height, width});
+  if (orientation) ori.attr("dim") = cpp11::as_sexp({height, width});
+
+  cpp11::writable::list out;
+  out.push_back(mag);
+  out.push_back(ori);
+  return out;
 }
@@ -2,16 +2,20 @@
 
 namespace aznyan {
 
-cpp11::integers azny_read(const cv::Mat& img) {
+cv::Mat to_bgra(const cv::Mat& img) {
   cv::Mat tmp;
   if (img.channels() == 3) {
     cv::cvtColor(img, tmp, cv::COLOR_BGR2BGRA);
   } else if (img.channels() == 1) {
     cv::cvtColor(img, tmp, cv::COLOR_GRAY2BGRA);
   } else {
-    tmp = std::move(img);
+    tmp = img;
   }
-  auto [bgra, ch] = aznyan::split_bgra(tmp);
+  return tmp;
+}
+
+cpp11::integers azny_read(const cv::Mat& img) {
+  auto [bgra, ch] = aznyan::split_bgra(to_bgra(img));
   cpp11::writable::integers out = aznyan::encode_nr(bgra[0], bgra[1]);
   out.attr("dim") = cpp11::as_sexp({img.rows, img.cols});
   return out;
@@ -19,6 +23,63 @@ cpp11::integers azny_read(const cv::Mat& img) {
 
 };  // namespace aznyan
 
+namespace {
+
+/**
+ * Animation written one frame at a time. OpenCV only encodes whole
+ * animations, so frames are kept as BGRA until the writer is closed.
+ */
+struct AnimationWriter {
+  std::string filename;
+  std::vector<int> params;
+#ifdef HAVE_ANIMATION
+  cv::Animation anim;
+#endif
+  bool closed;
+};
+
+/**
+ * Animation that is read a range of frames at a time. Only the frame
+ * count is read up front; frames and their durations are decoded on request.
+ * cv::imreadanimation() has no way to resume, so every read decodes again
+ * from the first frame. cv::ImageCollection could resume, but it does not
+ * report frame durations.
+ */
+struct AnimationReader {
+  std::string filename;
+  int count;
+  int position;
+};
+
+#ifndef HAVE_ANIMATION
+[[noreturn]] void stop_no_animation() {
+  cpp11::stop(
+      "Animations require OpenCV >= 4.11, "
+      "but this package was built against an older version.");
+}
+#else
+AnimationWriter& get_writer(SEXP handle) {
+  cpp11::external_pointer<AnimationWriter> ptr(handle);
+  if (ptr.get() == nullptr) {
+    cpp11::stop("Invalid animation writer handle.");
+  }
+  if (ptr->closed) {
+    cpp11::stop("Animation writer is already closed.");
+  }
+  return *ptr;
+}
+#endif
+
+AnimationReader& get_reader(SEXP handle) {
+  cpp11::external_pointer<AnimationReader> ptr(handle);
+  if (ptr.get() == nullptr) {
+    cpp11::stop("Invalid animation reader handle.");
+  }
+  return *ptr;
+}
+
+}  // namespace
+
 [[cpp11::register]]
 cpp11::integers azny_read_still(const std::string& filename) {
   if (!cv::haveImageReader(filename)) {
@@ -86,9 +147,7 @@ std::string azny_write_animation(const std::vector<std::string>& frames,
                                  const std::string& filename, int duration,
                                  int quality, int loop_count) {
 #ifndef HAVE_ANIMATION
-  cpp11::stop(
-      "Animation writing requires OpenCV >= 4.11, "
-      "but this package was built against an older version.");
+  stop_no_animation();
 #else
   if (!cv::haveImageWriter(filename)) {
     cpp11::stop("Unsupported image format.");
@@ -97,11 +156,11 @@ std::string azny_write_animation(const std::vector<std::string>& frames,
   cv::Animation anim = cv::Animation{loop_count, cv::Scalar()};
 
   for (const auto& frame : frames) {
-    cv::Mat img = cv::imread(frame, cv::IMREAD_COLOR);
+    cv::Mat img = cv::imread(frame, cv::IMREAD_UNCHANGED);
     if (img.empty()) {
       cpp11::stop("Failed to read image file: %s", frame.c_str());
     }
-    anim.frames.push_back(img);
+    anim.frames.push_back(aznyan::to_bgra(img));
     anim.durations.push_back(duration);
   }
   cv::imwriteanimation(filename, anim, params);
@@ -109,3 +168,117 @@ std::string azny_write_animation(const std::vector<std::string>& frames,
   return filename;
 #endif
 }
+
+[[cpp11::register]]
+SEXP azny_animation_writer(const std::string& filename, int quality,
+                           int loop_count) {
+#ifndef HAVE_ANIMATION
+  stop_no_animation();
+#else
+  if (!cv::haveImageWriter(filename)) {
+    cpp11::stop("Unsupported image format.");
+  }
+  auto* writer = new AnimationWriter{
+      filename, {cv::IMWRITE_WEBP_QUALITY, quality},
+      cv::Animation{loop_count, cv::Scalar()}, false};
+  cpp11::external_pointer<AnimationWriter> ptr(writer);
+  return ptr;
+#endif
+}
+
+[[cpp11::register]]
+int azny_animation_push(SEXP handle, const cpp11::integers& nr, int height,
+                        int width, int duration) {
+#ifndef HAVE_ANIMATION
+  stop_no_animation();
+#else
+  AnimationWriter& writer = get_writer(handle);
+  if (!writer.anim.frames.empty() &&
+      writer.anim.frames[0].size() != cv::Size(width, height)) {
+    cpp11::stop("All frames must have the same dimensions.");
+  }
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  cv::Mat frame;
+  cv::merge(bgra, frame);
+  writer.anim.frames.push_back(frame);
+  writer.anim.durations.push_back(duration);
+  return static_cast<int>(writer.anim.frames.size());
+#endif
+}
+
+[[cpp11::register]]
+std::string azny_animation_close(SEXP handle) {
+#ifndef HAVE_ANIMATION
+  stop_no_animation();
+#else
+  AnimationWriter& writer = get_writer(handle);
+  if (writer.anim.frames.empty()) {
+    cpp11::stop("Animation has no frames.");
+  }
+  const bool ok =
+      cv::imwriteanimation(writer.filename, writer.anim, writer.params);
+  writer.closed = true;
+  writer.anim = cv::Animation();
+  if (!ok) {
+    cpp11::stop("Failed to write animation: %s", writer.filename.c_str());
+  }
+  return writer.filename;
+#endif
+}
+
+[[cpp11::register]]
+SEXP azny_animation_reader(const std::string& filename) {
+#ifndef HAVE_ANIMATION
+  stop_no_animation();
+#else
+  if (!cv::haveImageReader(filename)) {
+    cpp11::stop("Unsupported image format.");
+  }
+  const size_t count = cv::imcount(filename, cv::IMREAD_UNCHANGED);
+  if (count == 0) {
+    cpp11::stop("Failed to read image file: %s", filename.c_str());
+  }
+  auto* reader = new AnimationReader{filename, static_cast<int>(count), 0};
+  cpp11::external_pointer<AnimationReader> ptr(reader);
+  return ptr;
+#endif
+}
+
+[[cpp11::register]]
+int azny_animation_count(SEXP handle) { return get_reader(handle).count; }
+
+/**
+ * Decodes up to `count` frames starting at `start` (0-based), or at the
+ * current position when `start` is negative, and moves the position past
+ * them. Returns the frames and their durations in milliseconds.
+ */
+[[cpp11::register]]
+cpp11::list azny_animation_read(SEXP handle, int start, int count) {
+#ifndef HAVE_ANIMATION
+  stop_no_animation();
+#else
+  AnimationReader& reader = get_reader(handle);
+  if (start >= 0) reader.position = std::min(start, reader.count);
+  count = std::min(count, reader.count - reader.position);
+
+  cpp11::writable::list frames;
+  cpp11::writable::integers durations;
+  if (count > 0) {
+    cv::Animation anim;
+    if (!cv::imreadanimation(reader.filename, anim, reader.position, count)) {
+      cpp11::stop("Failed to read animation: %s", reader.filename.c_str());
+    }
+    for (size_t i = 0; i < anim.frames.size(); ++i) {
+      frames.push_back(aznyan::azny_read(anim.frames[i]));
+      durations.push_back(i < anim.durations.size() ? anim.durations[i]
+                                                    : NA_INTEGER);
+    }
+    reader.position += static_cast<int>(anim.frames.size());
+  }
+
+  cpp11::writable::list out;
+  out.push_back(frames);
+  out.push_back(durations);
+  return out;
+#endif
+}
@@ -0,0 +1,167 @@
+#include "aznyan_color.h"
+
+namespace {
+
+/**
+ * Image held in linear light between operations, so that a chain of blurs
+ * and blends is decoded from sRGB and encoded back only once. Alpha is not
+ * gamma-encoded and is carried along as is.
+ */
+struct LinearImage {
+  cv::Mat bgr;    // CV_32FC3
+  cv::Mat alpha;  // CV_8UC1
+};
+
+const LinearImage& get_linear(SEXP handle) {
+  cpp11::external_pointer<LinearImage> ptr(handle);
+  if (ptr.get() == nullptr) {
+    cpp11::stop("Invalid linear image handle.");
+  }
+  return *ptr;
+}
+
+SEXP wrap_linear(LinearImage* img) {
+  cpp11::external_pointer<LinearImage> ptr(img);
+  return ptr;
+}
+
+inline float alpha_blend(float x1, float x2) {
+  return clampf(x1 + x2 * (1.0f - x1), 0.0f, 1.0f);
+}
+
+/**
+ * Same formulas as the blend_*() functions, applied to linear values.
+ * `sa` is the source alpha, used by the "over" mode only.
+ */
+template <int Mode>
+inline float blend_value(float s, float d, float sa) {
+  switch (Mode) {
+    case 0:  // alpha
+      return alpha_blend(s, d);
+    case 1:  // darken
+      return std::min(s, d);
+    case 2:  // multiply
+      return s * d;
+    case 3:  // lighten
+      return std::max(s, d);
+    case 4:  // screen
+      return clampf(1.0f - (1.0f - d) * (1.0f - s), 0.0f, 1.0f);
+    case 5:  // add
+      return clampf(s + d, 0.0f, 1.0f);
+    case 6:  // average
+      return (s + d) / 2.0f;
+    case 7:  // difference
+      return std::abs(d - s);
+    case 8:  // subtract
+      return clampf(d - s, 0.0f, 1.0f);
+    default:  // over
+      return s * sa + d * (1.0f - sa);
+  }
+}
+
+template <int Mode>
+void blend_linear(const LinearImage& src, const LinearImage& dst,
+                  LinearImage& out) {
+  aznyan::parallel_for(0, src.bgr.rows, [&](int y) {
+    const cv::Vec3f* s = src.bgr.ptr<cv::Vec3f>(y);
+    const cv::Vec3f* d = dst.bgr.ptr<cv::Vec3f>(y);
+    const uchar* sa = src.alpha.ptr<uchar>(y);
+    const uchar* da = dst.alpha.ptr<uchar>(y);
+    cv::Vec3f* o = out.bgr.ptr<cv::Vec3f>(y);
+    uchar* oa = out.alpha.ptr<uchar>(y);
+    for (int x = 0; x < src.bgr.cols; x++) {
+      const float a = sa[x] / 255.0f;
+      for (int c = 0; c < 3; c++) {
+        o[x][c] = blend_value<Mode>(s[x][c], d[x][c], a);
+      }
+      oa[x] = to_uchar(alpha_blend(a, da[x] / 255.0f) * 255.0f);
+    }
+  });
+}
+
+}  // namespace
+
+[[cpp11::register]]
+SEXP azny_linear_decode(const cpp11::integers& nr, int height, int width) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  return wrap_linear(
+      new LinearImage{aznyan::decode_linear(bgra[0]), bgra[1]});
+}
+
+[[cpp11::register]]
+cpp11::integers azny_linear_encode(SEXP handle) {
+  const LinearImage& img = get_linear(handle);
+  return aznyan::encode_nr(aznyan::encode_linear(img.bgr), img.alpha);
+}
+
+[[cpp11::register]]
+cpp11::integers azny_linear_dim(SEXP handle) {
+  const LinearImage& img = get_linear(handle);
+  return cpp11::as_sexp({img.bgr.rows, img.bgr.cols});
+}
+
+[[cpp11::register]]
+SEXP azny_linear_boxblur(SEXP handle, int boxW, int boxH, bool normalize,
+                         int border) {
+  const LinearImage& img = get_linear(handle);
+  cv::Mat out;
+  cv::boxFilter(img.bgr, out, -1, cv::Size(boxW, boxH), cv::Point(-1, -1),
+                normalize, aznyan::mode_a[border]);
+  return wrap_linear(new LinearImage{out, img.alpha});
+}
+
+[[cpp11::register]]
+SEXP azny_linear_gaussianblur(SEXP handle, int boxW, int boxH, double sigmaX,
+                              double sigmaY, int border) {
+  const LinearImage& img = get_linear(handle);
+  const int kx = std::max(2 * boxW - 1, 0);
+  const int ky = std::max(2 * boxH - 1, 0);
+  cv::Mat out;
+  cv::GaussianBlur(img.bgr, out, cv::Size(kx, ky), sigmaX, sigmaY,
+                   aznyan::mode_a[border]);
+  return wrap_linear(new LinearImage{out, img.alpha});
+}
+
+[[cpp11::register]]
+SEXP azny_linear_blend(SEXP src, SEXP dst, int mode) {
+  const LinearImage& s = get_linear(src);
+  const LinearImage& d = get_linear(dst);
+  if (s.bgr.size() != d.bgr.size()) {
+    cpp11::stop("src and dst must have the same dimensions.");
+  }
+  LinearImage out{cv::Mat(s.bgr.size(), CV_32FC3),
+                  cv::Mat(s.bgr.size(), CV_8UC1)};
+  switch (mode) {
+    case 0:
+      blend_linear<0>(s, d, out);
+      break;
+    case 1:
+      blend_linear<1>(s, d, out);
+      break;
+    case 2:
+      blend_linear<2>(s, d, out);
+      break;
+    case 3:
+      blend_linear<3>(s, d, out);
+      break;
+    case 4:
+      blend_linear<4>(s, d, out);
+      break;
+    case 5:
+      blend_linear<5>(s, d, out);
+      break;
+    case 6:
+      blend_linear<6>(s, d, out);
+      break;
+    case 7:
+      blend_linear<7>(s, d, out);
+      break;
+    case 8:
+      blend_linear<8>(s, d, out);
+      break;
+    default:
+      blend_linear<9>(s, d, out);
+      break;
+  }
+  return wrap_linear(new LinearImage{out.bgr, out.alpha});
+}
@@ -1,4 +1,19 @@
 #include "aznyan_types.h"
+#include <array>
+
+namespace {
+
+struct WeaveState {
+  double lumisum;
+  int drawpx;
+  int drawing;
+  int interval;
+};
+
+// Columns walked together by the vertical pass.
+constexpr int kWeaveLanes = 16;
+
+}  // namespace
 
 [[cpp11::register]]
 cpp11::integers azny_lineweave(const cpp11::integers& nr, int height, int width,
@@ -20,100 +35,69 @@ cpp11::integers azny_lineweave(const cpp11::integers& nr, int height, int width,
   cv::Mat tmp_bg = bgra_bg[0];  // CV_8UC3
   cv::Mat out(gray.size(), CV_8UC3);
 
-  auto step_state = [&](double& lumisum, int& drawpx, int& drawing,
-                        int& interval, uchar g) {
-    // g: 0..255
-    double lumi = srgb_to_linear(static_cast<double>(g) / 255.0);
-    lumisum += (invert) ? lumi * omega : (1.0 - lumi) * omega;
+  // Amount each gray level adds to the running sum.
+  std::array<double, 256> weight;
+  for (int g = 0; g < 256; ++g) {
+    const double lumi = srgb_to_linear(static_cast<double>(g) / 255.0);
+    weight[g] = (invert) ? lumi * omega : (1.0 - lumi) * omega;
+  }
 
-    if (lumisum >= phase) {
-      lumisum = 0;
-      if (interval == 0 && drawing == 0) {
-        drawing = dist1;
-        interval = dist2;
-      } else if (interval == 0 && drawing > 0) {
-        drawpx = dist3;
-        drawing--;
+  // Advances the state by one pixel and returns whether it is drawn.
+  auto step_state = [&](WeaveState& s, uchar g) {
+    s.lumisum += weight[g];
+    if (s.lumisum >= phase) {
+      s.lumisum = 0;
+      if (s.interval == 0 && s.drawing == 0) {
+        s.drawing = dist1;
+        s.interval = dist2;
+      } else if (s.interval == 0 && s.drawing > 0) {
+        s.drawpx = dist3;
+        s.drawing--;
       } else {
-        interval--;
+        s.interval--;
       }
     }
+    if (s.drawpx > 0) {
+      s.drawpx--;
+      return true;
+    }
+    return false;
   };
+  const WeaveState init{0, 0, dist1, 0};
 
   const bool outerIsRow = (direction == 0 || direction == 3);
   const bool innerReverse = (direction == 0 || direction == 2);
 
   if (outerIsRow) {
     aznyan::parallel_for(0, height, [&](int y) {
-      double lumisum = 0;
-      int drawpx = 0;
-      int drawing = dist1;
-      int interval = 0;
-
+      WeaveState s = init;
       const uchar* gRow = gray.ptr<uchar>(y);
       const cv::Vec3b* fgRow = tmp_fg.ptr<cv::Vec3b>(y);
       const cv::Vec3b* bgRow = tmp_bg.ptr<cv::Vec3b>(y);
       cv::Vec3b* outRow = out.ptr<cv::Vec3b>(y);
-
-      if (!innerReverse) {
-        for (int x = 0; x < width; ++x) {
-          step_state(lumisum, drawpx, drawing, interval, gRow[x]);
-          if (drawpx > 0) {
-            outRow[x] = fgRow[x];
-            drawpx--;
-          } else {
-            outRow[x] = bgRow[x];
-          }
-        }
-      } else {
-        for (int x = width - 1; x >= 0; --x) {
-          step_state(lumisum, drawpx, drawing, interval, gRow[x]);
-          if (drawpx > 0) {
-            outRow[x] = fgRow[x];
-            drawpx--;
-          } else {
-            outRow[x] = bgRow[x];
-          }
-        }
+      for (int i = 0; i < width; ++i) {
+        const int x = innerReverse ? width - 1 - i : i;
+        outRow[x] = step_state(s, gRow[x]) ? fgRow[x] : bgRow[x];
       }
     });
-
   } else {
-    aznyan::parallel_for(0, width, [&](int x) {
-      double lumisum = 0;
-      int drawpx = 0;
-      int drawing = dist1;
-      int interval = 0;
-
-      if (!innerReverse) {
-        for (int y = 0; y < height; ++y) {
-          const uchar* gRow = gray.ptr<uchar>(y);
-          const cv::Vec3b* fgRow = tmp_fg.ptr<cv::Vec3b>(y);
-          const cv::Vec3b* bgRow = tmp_bg.ptr<cv::Vec3b>(y);
-          cv::Vec3b* outRow = out.ptr<cv::Vec3b>(y);
-
-          step_state(lumisum, drawpx, drawing, interval, gRow[x]);
-          if (drawpx > 0) {
-            outRow[x] = fgRow[x];
-            drawpx--;
-          } else {
-            outRow[x] = bgRow[x];
-          }
-        }
-      } else {
-        for (int y = height - 1; y >= 0; --y) {
-          const uchar* gRow = gray.ptr<uchar>(y);
-          const cv::Vec3b* fgRow = tmp_fg.ptr<cv::Vec3b>(y);
-          const cv::Vec3b* bgRow = tmp_bg.ptr<cv::Vec3b>(y);
-          cv::Vec3b* outRow = out.ptr<cv::Vec3b>(y);
-
-          step_state(lumisum, drawpx, drawing, interval, gRow[x]);
-          if (drawpx > 0) {
-            outRow[x] = fgRow[x];
-            drawpx--;
-          } else {
-            outRow[x] = bgRow[x];
-          }
+    // Each column carries its own state, so neighbouring columns are
+    // walked together row by row to keep memory access contiguous.
+    const int bands = (width + kWeaveLanes - 1) / kWeaveLanes;
+    aznyan::parallel_for(0, bands, [&](int b) {
+      const int x0 = b * kWeaveLanes;
+      const int x1 = std::min(width, x0 + kWeaveLanes);
+      std::array<WeaveState, kWeaveLanes> lanes;
+      lanes.fill(init);
+      for (int i = 0; i < height; ++i) {
+        const int y = innerReverse ? height - 1 - i : i;
+        const uchar* gRow = gray.ptr<uchar>(y);
+        const cv::Vec3b* fgRow = tmp_fg.ptr<cv::Vec3b>(y);
+        const cv::Vec3b* bgRow = tmp_bg.ptr<cv::Vec3b>(y);
+        cv::Vec3b* outRow = out.ptr<cv::Vec3b>(y);
+        for (int x = x0; x < x1; ++x) {
+          outRow[x] =
+              step_state(lanes[x - x0], gRow[x]) ? fgRow[x] : bgRow[x];
         }
       }
     });
@@ -1,5 +1,334 @@
 #include "aznyan_types.h"
 
+namespace {
+
+// Structuring elements smaller than this are left to cv::morphologyEx.
+constexpr int kMorphMinArea = 9 * 9;
+// Width of the column bands that vertical passes are split into.
+constexpr int kMorphBand = 64;
+
+struct MinOp {
+  static constexpr uchar border_value = 255;
+  uchar operator()(uchar a, uchar b) const { return std::min(a, b); }
+};
+
+struct MaxOp {
+  static constexpr uchar border_value = 0;
+  uchar operator()(uchar a, uchar b) const { return std::max(a, b); }
+};
+
+/**
+ * Columns [x0, x1] of rows [y0, y1] of a structuring element.
+ */
+struct MorphRect {
+  int x0, x1, y0, y1;
+};
+
+/**
+ * Decomposes a structuring element into rectangles by grouping consecutive
+ * rows that share the same run of nonzero pixels. Rectangles sharing a run
+ * are kept next to each other. Returns an empty vector if some row has more
+ * than one run, or if the element is empty.
+ *
+ * A cross gives three rectangles, while an ellipse of radius r gives up to
+ * 2r + 1, one for each run of rows of equal width.
+ */
+std::vector<MorphRect> decompose_element(const cv::Mat& kernel) {
+  std::vector<MorphRect> rects;
+  for (int y = 0; y < kernel.rows; y++) {
+    const uchar* k = kernel.ptr<uchar>(y);
+    int x0 = -1, x1 = -1;
+    for (int x = 0; x < kernel.cols; x++) {
+      if (!k[x]) continue;
+      if (x0 >= 0 && x1 != x - 1) return {};
+      if (x0 < 0) x0 = x;
+      x1 = x;
+    }
+    if (x0 < 0) continue;
+    if (!rects.empty() && rects.back().y1 == y - 1 && rects.back().x0 == x0 &&
+        rects.back().x1 == x1) {
+      rects.back().y1 = y;
+    } else {
+      rects.push_back(MorphRect{x0, x1, y, y});
+    }
+  }
+  std::stable_sort(rects.begin(), rects.end(),
+                   [](const MorphRect& a, const MorphRect& b) {
+                     return std::tie(a.x0, a.x1) < std::tie(b.x0, b.x1);
+                   });
+  return rects;
+}
+
+/**
+ * Structuring element of one channel: its rectangles, size and anchor.
+ */
+struct MorphElement {
+  std::vector<MorphRect> rects;
+  cv::Size ksize;
+  cv::Point anchor;
+};
+
+/**
+ * Running min/max over rows, after van Herk/Gil-Werman. For each channel
+ * `c` with `runs[c] = (x0, len)`, sets
+ * `out(r, x, c) = op(src(r, x0 + x, c), ..., src(r, x0 + x + len - 1, c))`.
+ * Channels with `len == 0` are left untouched.
+ */
+template <typename Op>
+void running_rows(const cv::Mat& src, cv::Mat& out,
+                  const std::vector<cv::Vec2i>& runs, Op op) {
+  const int cn = src.channels();
+  const int width = out.cols;
+  aznyan::parallel_for(0, src.rows, [&](int r) {
+    const uchar* in = src.ptr<uchar>(r);
+    uchar* dst = out.ptr<uchar>(r);
+    std::vector<uchar> g, h;
+    for (int c = 0; c < cn; c++) {
+      const int len = runs[c][1];
+      if (len == 0) continue;
+      const uchar* p = in + runs[c][0] * cn + c;
+      const int n = width + len - 1;
+      g.resize(n);
+      h.resize(n);
+      for (int i = 0; i < n; i++) {
+        g[i] = i % len == 0 ? p[i * cn] : op(g[i - 1], p[i * cn]);
+      }
+      for (int i = n - 1; i >= 0; i--) {
+        h[i] = (i == n - 1 || i % len == len - 1) ? p[i * cn]
+                                                  : op(h[i + 1], p[i * cn]);
+      }
+      for (int x = 0; x < width; x++) {
+        dst[x * cn + c] = op(h[x], g[x + len - 1]);
+      }
+    }
+  });
+}
+
+/**
+ * Running min/max over columns. For each channel `c` with
+ * `spans[c] = (y0, len)`, sets
+ * `out(y, x, c) = op(src(y0 + y, x, c), ..., src(y0 + y + len - 1, x, c))`.
+ * Whole rows of a column band are processed at once.
+ */
+template <typename Op>
+void running_cols(const cv::Mat& src, cv::Mat& out,
+                  const std::vector<cv::Vec2i>& spans, Op op) {
+  const int cn = src.channels();
+  const int width = out.cols;
+  const int height = out.rows;
+  const int bands = (width + kMorphBand - 1) / kMorphBand;
+  aznyan::parallel_for(0, bands, [&](int b) {
+    const int bx = b * kMorphBand;
+    const int bw = std::min(kMorphBand, width - bx);
+    std::vector<uchar> g, h;
+    for (int c = 0; c < cn; c++) {
+      const int y0 = spans[c][0];
+      const int len = spans[c][1];
+      const auto at = [&](int i) {
+        return src.ptr<uchar>(y0 + i) + bx * cn + c;
+      };
+      if (len == 1) {
+        for (int y = 0; y < height; y++) {
+          const uchar* in = at(y);
+          uchar* dst = out.ptr<uchar>(y) + bx * cn + c;
+          for (int x = 0; x < bw; x++) dst[x * cn] = in[x * cn];
+        }
+        continue;
+      }
+      const int n = height + len - 1;
+      g.resize(static_cast<std::size_t>(n) * bw);
+      h.resize(static_cast<std::size_t>(n) * bw);
+      for (int i = 0; i < n; i++) {
+        const uchar* in = at(i);
+        uchar* gi = &g[static_cast<std::size_t>(i) * bw];
+        if (i % len == 0) {
+          for (int x = 0; x < bw; x++) gi[x] = in[x * cn];
+        } else {
+          for (int x = 0; x < bw; x++) gi[x] = op(gi[x - bw], in[x * cn]);
+        }
+      }
+      for (int i = n - 1; i >= 0; i--) {
+        const uchar* in = at(i);
+        uchar* hi = &h[static_cast<std::size_t>(i) * bw];
+        if (i == n - 1 || i % len == len - 1) {
+          for (int x = 0; x < bw; x++) hi[x] = in[x * cn];
+        } else {
+          for (int x = 0; x < bw; x++) hi[x] = op(hi[x + bw], in[x * cn]);
+        }
+      }
+      for (int y = 0; y < height; y++) {
+        const uchar* hy = &h[static_cast<std::size_t>(y) * bw];
+        const uchar* gy = &g[static_cast<std::size_t>(y + len - 1) * bw];
+        uchar* dst = out.ptr<uchar>(y) + bx * cn + c;
+        for (int x = 0; x < bw; x++) dst[x * cn] = op(hy[x], gy[x]);
+      }
+    }
+  });
+}
+
+/**
+ * Erodes or dilates `src` once, with its own structuring element for each
+ * channel. Each rectangle costs a horizontal and a vertical running pass,
+ * whatever its size; horizontal passes are only redone for channels whose
+ * run changes. Channels with fewer rectangles repeat their last one, which
+ * is harmless as min and max are idempotent. Borders are extrapolated as
+ * cv::morphologyEx does.
+ */
+template <typename Op>
+cv::Mat morph_step(const cv::Mat& src, const std::vector<MorphElement>& elems,
+                   int border, Op op) {
+  const int cn = src.channels();
+  int top = 0, bottom = 0, left = 0, right = 0;
+  std::size_t steps = 0;
+  for (const auto& e : elems) {
+    top = std::max(top, e.anchor.y);
+    bottom = std::max(bottom, e.ksize.height - 1 - e.anchor.y);
+    left = std::max(left, e.anchor.x);
+    right = std::max(right, e.ksize.width - 1 - e.anchor.x);
+    steps = std::max(steps, e.rects.size());
+  }
+  cv::Mat padded;
+  cv::copyMakeBorder(src, padded, top, bottom, left, right, border,
+                     cv::Scalar::all(Op::border_value));
+
+  cv::Mat run(padded.rows, src.cols, src.type());
+  cv::Mat part(src.rows, src.cols, src.type());
+  cv::Mat out;
+  std::vector<cv::Vec2i> runs(cn), spans(cn), last(cn, cv::Vec2i(-1, -1));
+  for (std::size_t s = 0; s < steps; s++) {
+    for (int c = 0; c < cn; c++) {
+      const auto& e = elems[c];
+      const auto& r = e.rects[std::min(s, e.rects.size() - 1)];
+      const cv::Vec2i rn(left - e.anchor.x + r.x0, r.x1 - r.x0 + 1);
+      runs[c] = rn == last[c] ? cv::Vec2i(0, 0) : rn;
+      last[c] = rn;
+      spans[c] = cv::Vec2i(top - e.anchor.y + r.y0, r.y1 - r.y0 + 1);
+    }
+    running_rows(padded, run, runs, op);
+    if (s == 0) {
+      out.create(src.rows, src.cols, src.type());
+      running_cols(run, out, spans, op);
+      continue;
+    }
+    running_cols(run, part, spans, op);
+    aznyan::parallel_for(0, src.rows, [&](int y) {
+      uchar* dst = out.ptr<uchar>(y);
+      const uchar* p = part.ptr<uchar>(y);
+      for (int x = 0; x < src.cols * cn; x++) dst[x] = op(dst[x], p[x]);
+    });
+  }
+  return out;
+}
+
+template <typename Op>
+cv::Mat morph_iterate(const cv::Mat& src, const std::vector<cv::Mat>& kernels,
+                      cv::Point anchor, int iterations, int border, Op op) {
+  const int cn = src.channels();
+  std::vector<MorphElement> elems(cn);
+  std::vector<int> iters(cn, iterations);
+  for (int c = 0; c < cn; c++) {
+    cv::Mat element = kernels[c];
+    cv::Point pt(anchor.x < 0 ? element.cols / 2 : anchor.x,
+                 anchor.y < 0 ? element.rows / 2 : anchor.y);
+    if (iterations > 1 &&
+        cv::countNonZero(element) == static_cast<int>(element.total())) {
+      // Iterating a rectangle is the same as one pass with a larger one.
+      // cv::morphologyEx collapses iterations in exactly the same way.
+      const cv::Size ksize(
+          element.cols + (iterations - 1) * (element.cols - 1),
+          element.rows + (iterations - 1) * (element.rows - 1));
+      element = cv::Mat::ones(ksize, CV_8UC1);
+      pt = cv::Point(pt.x * iterations, pt.y * iterations);
+      iters[c] = 1;
+    }
+    elems[c] = MorphElement{decompose_element(element), element.size(), pt};
+  }
+
+  // Channels that have run out of iterations pass through unchanged.
+  const MorphElement identity{{MorphRect{0, 0, 0, 0}}, cv::Size(1, 1),
+                              cv::Point(0, 0)};
+  const int max_iters = *std::max_element(iters.begin(), iters.end());
+  std::vector<MorphElement> step(cn);
+  cv::Mat out = src;
+  for (int i = 0; i < max_iters; i++) {
+    for (int c = 0; c < cn; c++) step[c] = i < iters[c] ? elems[c] : identity;
+    out = morph_step(out, step, border, op);
+  }
+  return out;
+}
+
+/**
+ * Drop-in for cv::morphologyEx on 8-bit images, with one structuring element
+ * per channel of `src`.
+ *
+ * Large elements that decompose into rectangles go through van Herk/Gil-Werman
+ * running passes over the interleaved image. Anything else is left to OpenCV,
+ * one channel at a time.
+ */
+void morphology_ex(const cv::Mat& src, cv::Mat& dst, int op,
+                   const std::vector<cv::Mat>& kernels, cv::Point anchor,
+                   int iterations, int border) {
+  bool fast = op != cv::MORPH_HITMISS && iterations >= 1;
+  int area = 0;
+  for (const auto& k : kernels) {
+    fast = fast && !decompose_element(k).empty();
+    area = std::max(area, k.rows * k.cols);
+  }
+  if (!fast || area < kMorphMinArea) {
+    if (kernels.size() == 1) {
+      cv::morphologyEx(src, dst, op, kernels[0], anchor, iterations, border);
+      return;
+    }
+    std::vector<cv::Mat> planes, outs(kernels.size());
+    cv::split(src, planes);
+    aznyan::parallel_for(0, static_cast<int>(planes.size()), [&](int c) {
+      cv::morphologyEx(planes[c], outs[c], op, kernels[c], anchor, iterations,
+                       border);
+    });
+    cv::merge(outs, dst);
+    return;
+  }
+
+  const auto erode = [&](const cv::Mat& m) {
+    return morph_iterate(m, kernels, anchor, iterations, border, MinOp{});
+  };
+  const auto dilate = [&](const cv::Mat& m) {
+    return morph_iterate(m, kernels, anchor, iterations, border, MaxOp{});
+  };
+  switch (op) {
+    case cv::MORPH_ERODE:
+      dst = erode(src);
+      break;
+    case cv::MORPH_DILATE:
+      dst = dilate(src);
+      break;
+    case cv::MORPH_OPEN:
+      dst = dilate(erode(src));
+      break;
+    case cv::MORPH_CLOSE:
+      dst = erode(dilate(src));
+      break;
+    case cv::MORPH_GRADIENT:
+      cv::subtract(dilate(src), erode(src), dst);
+      break;
+    case cv::MORPH_TOPHAT:
+      cv::subtract(src, dilate(erode(src)), dst);
+      break;
+    case cv::MORPH_BLACKHAT:
+      cv::subtract(erode(dilate(src)), src, dst);
+      break;
+  }
+}
+
+void morphology_ex(const cv::Mat& src, cv::Mat& dst, int op,
+                   const cv::Mat& kernel, cv::Point anchor, int iterations,
+                   int border) {
+  morphology_ex(src, dst, op, std::vector<cv::Mat>{kernel}, anchor, iterations,
+                border);
+}
+
+}  // namespace
+
 [[cpp11::register]]
 cpp11::integers azny_morphologyfilter(const cpp11::integers& nr, int height,
                                       int width, int ksize, int ktype, int mode,
@@ -20,12 +349,12 @@ cpp11::integers azny_morphologyfilter(const cpp11::integers& nr, int height,
   cv::Point anchor(pt[0], pt[1]);
   cv::Mat kernel = getStructuringElement(aznyan::kshape[ktype],
                                          cv::Size(ksize, ksize), anchor);
-  cv::morphologyEx(tmpB, tmpC, aznyan::opmode[mode], kernel, anchor, iterations,
-                   aznyan::mode_a[border]);
+  morphology_ex(tmpB, tmpC, aznyan::opmode[mode], kernel, anchor, iterations,
+                aznyan::mode_a[border]);
 
   if (alphasync)
-    cv::morphologyEx(bgra[1], tmpD, aznyan::opmode[mode], kernel, anchor,
-                     iterations, aznyan::mode_a[border]);
+    morphology_ex(bgra[1], tmpD, aznyan::opmode[mode], kernel, anchor,
+                  iterations, aznyan::mode_a[border]);
   else
     tmpD = bgra[1].clone();
 
@@ -44,9 +373,6 @@ cpp11::integers azny_morphologyrgb(const cpp11::integers& nr, int height,
   cv::Mat tmpB = cv::Mat::zeros(bgra[0].size(), CV_8UC3);
   bgra[0].copyTo(tmpB, bgra[1]);
 
-  std::vector<cv::Mat> col_ch;
-  cv::split(tmpB, col_ch);
-
   if (pt.size() < 2 || cpp11::is_na(pt[0]) || cpp11::is_na(pt[1])) {
     cpp11::stop("Invalid anchor point.");
   }
@@ -61,27 +387,110 @@ cpp11::integers azny_morphologyrgb(const cpp11::integers& nr, int height,
         aznyan::kshape[ktype], cv::Size(2 * ksize[i] - 1, 2 * ksize[i] - 1),
         anchor);
     kernel.emplace_back(tmpB);
-    col_ch.emplace_back(bgra[1]);
   }
 
-  cv::Mat tmpC = cv::Mat::zeros(bgra[0].size(), CV_8UC1);
-  std::vector<cv::Mat> tmpD(6, tmpC);
   iterations = std::max(iterations, 1);
-  aznyan::parallel_for(0, 6, [&](int j) {
-    cv::Mat tmpE;
-    cv::morphologyEx(col_ch[j], tmpE, aznyan::opmode[mode], kernel[j % 3],
-                     anchor, iterations, aznyan::mode_a[border]);
-    tmpD[j] = tmpE.clone();
-  });
+  cv::Mat out;
+  morphology_ex(tmpB, out, aznyan::opmode[mode], kernel, anchor, iterations,
+                aznyan::mode_a[border]);
+
+  // The alpha channel gets the saturated sum of its results for the three
+  // kernels, so each distinct kernel is processed once and added as many
+  // times as it occurs.
+  cv::Mat tmpC;
   if (alphasync) {
+    tmpC = cv::Mat::zeros(bgra[0].size(), CV_8UC1);
     for (int i = 0; i < 3; ++i) {
-      cv::add(tmpC, tmpD[3 + i], tmpC);
+      bool seen = false;
+      for (int j = 0; j < i; ++j) seen = seen || ksize[j] == ksize[i];
+      if (seen) continue;
+      cv::Mat tmpD;
+      morphology_ex(bgra[1], tmpD, aznyan::opmode[mode], kernel[i], anchor,
+                    iterations, aznyan::mode_a[border]);
+      for (int j = i; j < 3; ++j) {
+        if (ksize[j] == ksize[i]) cv::add(tmpC, tmpD, tmpC);
+      }
     }
   } else {
-    col_ch[3].copyTo(tmpC);
+    tmpC = bgra[1];
   }
 
-  cv::Mat out;
-  cv::merge(std::vector<cv::Mat>{tmpD[0], tmpD[1], tmpD[2]}, out);
   return aznyan::encode_nr(out, tmpC);
 }
+
+[[cpp11::register]]
+cpp11::integers azny_outline(const cpp11::integers& nr, int height, int width,
+                             double size, double softness, int position,
+                             int color, int threshold) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+
+  // Pixels whose alpha reaches `threshold` are inside the shape. The stroke
+  // is drawn from the Euclidean distance to the nearest pixel on the other
+  // side, so any width costs one linear-time transform per side.
+  cv::Mat inside, outside, dist_out, dist_in;
+  cv::compare(bgra[1], cv::Scalar::all(threshold), inside, cv::CMP_GE);
+  cv::bitwise_not(inside, outside);
+  if (position != 1) {
+    cv::distanceTransform(outside, dist_out, cv::DIST_L2,
+                          cv::DIST_MASK_PRECISE);
+  }
+  if (position != 0) {
+    cv::distanceTransform(inside, dist_in, cv::DIST_L2, cv::DIST_MASK_PRECISE);
+  }
+
+  const float stroke = static_cast<float>(size);
+  const float soft = static_cast<float>(softness);
+  const auto coverage = [&](float d) {
+    const float t = d - stroke;
+    if (t <= 0.0f) return 1.0f;
+    if (soft <= 0.0f) return clampf(1.0f - t, 0.0f, 1.0f);
+    const float u = clampf(t / soft, 0.0f, 1.0f);
+    return 1.0f - u * u * (3.0f - 2.0f * u);
+  };
+
+  const auto [cr, cg, cb, ca] = aznyan::int_to_rgba(color);
+  const std::array<float, 3> col{static_cast<float>(cb), static_cast<float>(cg),
+                                 static_cast<float>(cr)};
+  const float col_a = ca / 255.0f;
+
+  cv::Mat out(height, width, CV_8UC3), alpha(height, width, CV_8UC1);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const cv::Vec3b* src = bgra[0].ptr<cv::Vec3b>(y);
+    const uchar* src_a = bgra[1].ptr<uchar>(y);
+    const uchar* in = inside.ptr<uchar>(y);
+    cv::Vec3b* dst = out.ptr<cv::Vec3b>(y);
+    uchar* dst_a = alpha.ptr<uchar>(y);
+    for (int x = 0; x < width; x++) {
+      std::array<float, 3> rgb{static_cast<float>(src[x][0]),
+                               static_cast<float>(src[x][1]),
+                               static_cast<float>(src[x][2])};
+      float a = src_a[x] / 255.0f;
+      if (position != 1 && !in[x]) {
+        // Outer stroke goes behind the image.
+        const float sa = col_a * coverage(dist_out.ptr<float>(y)[x]);
+        const float oa = a + sa * (1.0f - a);
+        if (oa > 0.0f) {
+          for (int c = 0; c < 3; c++) {
+            rgb[c] = (rgb[c] * a + col[c] * sa * (1.0f - a)) / oa;
+          }
+        }
+        a = oa;
+      }
+      if (position != 0 && in[x]) {
+        // Inner stroke goes over the image.
+        const float sa = col_a * coverage(dist_in.ptr<float>(y)[x]);
+        const float oa = sa + a * (1.0f - sa);
+        if (oa > 0.0f) {
+          for (int c = 0; c < 3; c++) {
+            rgb[c] = (col[c] * sa + rgb[c] * a * (1.0f - sa)) / oa;
+          }
+        }
+        a = oa;
+      }
+      for (int c = 0; c < 3; c++) dst[x][c] = cv::saturate_cast<uchar>(rgb[c]);
+      dst_a[x] = cv::saturate_cast<uchar>(a * 255.0f);
+    }
+  });
+
+  return aznyan::encode_nr(out, alpha);
+}
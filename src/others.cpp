@@ -1,109 +1,6 @@
-#include "aznyan_types.h"
+#include "aznyan_quantize.h"
 #include <opencv2/xphoto.hpp>
 
-namespace {
-
-struct MedianCutColor {
-  uchar b;
-  uchar g;
-  uchar r;
-  int count;
-};
-
-struct MedianCutBox {
-  std::vector<int> color_ids;
-};
-
-struct MedianCutStats {
-  int channel;
-  int range;
-  int population;
-  bool splittable;
-};
-
-inline uint32_t pack_rgb(uchar b, uchar g, uchar r) {
-  return static_cast<uint32_t>(b) | (static_cast<uint32_t>(g) << 8) |
-         (static_cast<uint32_t>(r) << 16);
-}
-
-inline int channel_value(const MedianCutColor& color, int channel) {
-  if (channel == 0) return color.b;
-  if (channel == 1) return color.g;
-  return color.r;
-}
-
-MedianCutStats compute_box_stats(const MedianCutBox& box,
-                                 const std::vector<MedianCutColor>& colors) {
-  std::array<int, 3> mins{255, 255, 255};
-  std::array<int, 3> maxs{0, 0, 0};
-  int population = 0;
-
-  for (const int color_id : box.color_ids) {
-    const auto& color = colors[color_id];
-    mins[0] = std::min(mins[0], static_cast<int>(color.b));
-    mins[1] = std::min(mins[1], static_cast<int>(color.g));
-    mins[2] = std::min(mins[2], static_cast<int>(color.r));
-    maxs[0] = std::max(maxs[0], static_cast<int>(color.b));
-    maxs[1] = std::max(maxs[1], static_cast<int>(color.g));
-    maxs[2] = std::max(maxs[2], static_cast<int>(color.r));
-    population += color.count;
-  }
-
-  const std::array<int, 3> ranges{maxs[0] - mins[0], maxs[1] - mins[1],
-                                  maxs[2] - mins[2]};
-
-  int channel = 0;
-  if (ranges[1] > ranges[channel]) channel = 1;
-  if (ranges[2] > ranges[channel]) channel = 2;
-
-  return MedianCutStats{
-      channel,
-      ranges[channel],
-      population,
-      box.color_ids.size() > 1 && ranges[channel] > 0,
-  };
-}
-
-bool split_box(const MedianCutBox& box,
-               const std::vector<MedianCutColor>& colors, int channel,
-               MedianCutBox* left, MedianCutBox* right) {
-  std::vector<int> sorted_ids = box.color_ids;
-  std::sort(sorted_ids.begin(), sorted_ids.end(), [&](int lhs, int rhs) {
-    const auto& a = colors[lhs];
-    const auto& b = colors[rhs];
-    const int av = channel_value(a, channel);
-    const int bv = channel_value(b, channel);
-    if (av != bv) return av < bv;
-    if (a.r != b.r) return a.r < b.r;
-    if (a.g != b.g) return a.g < b.g;
-    if (a.b != b.b) return a.b < b.b;
-    return lhs < rhs;
-  });
-
-  int total = 0;
-  for (const int color_id : sorted_ids) {
-    total += colors[color_id].count;
-  }
-
-  const int target = (total + 1) / 2;
-  int cumulative = 0;
-  int split_at = static_cast<int>(sorted_ids.size()) / 2;
-  for (int i = 0; i < static_cast<int>(sorted_ids.size()) - 1; ++i) {
-    cumulative += colors[sorted_ids[i]].count;
-    if (cumulative >= target) {
-      split_at = i + 1;
-      break;
-    }
-  }
-
-  split_at = std::clamp(split_at, 1, static_cast<int>(sorted_ids.size()) - 1);
-  left->color_ids.assign(sorted_ids.begin(), sorted_ids.begin() + split_at);
-  right->color_ids.assign(sorted_ids.begin() + split_at, sorted_ids.end());
-  return !left->color_ids.empty() && !right->color_ids.empty();
-}
-
-}  // namespace
-
 [[cpp11::register]]
 cpp11::integers azny_det_enhance(const cpp11::integers& nr, int height,
                                  int width, double sgmS, double sgmR) {
@@ -179,105 +76,42 @@ cpp11::integers azny_median_cut(const cpp11::integers& nr, int height,
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
   const cv::Mat& bgr = bgra[0];
 
-  std::unordered_map<uint32_t, int> counts;
-  counts.reserve(static_cast<size_t>(height) * static_cast<size_t>(width));
-  for (int y = 0; y < height; ++y) {
-    const cv::Vec3b* row = bgr.ptr<cv::Vec3b>(y);
-    for (int x = 0; x < width; ++x) {
-      const cv::Vec3b& px = row[x];
-      ++counts[pack_rgb(px[0], px[1], px[2])];
-    }
-  }
-
-  if (static_cast<int>(counts.size()) <= n_colors) {
-    return aznyan::encode_nr(bgr, bgra[1]);
-  }
-
-  std::vector<MedianCutColor> colors;
-  colors.reserve(counts.size());
-  for (const auto& [packed, count] : counts) {
-    colors.push_back(MedianCutColor{
-        static_cast<uchar>(packed & 0xFF),
-        static_cast<uchar>((packed >> 8) & 0xFF),
-        static_cast<uchar>((packed >> 16) & 0xFF),
-        count,
-    });
-  }
-  counts.clear();
-
-  MedianCutBox root;
-  root.color_ids.reserve(colors.size());
-  for (int i = 0; i < static_cast<int>(colors.size()); ++i) {
-    root.color_ids.push_back(i);
-  }
-
-  std::vector<MedianCutBox> boxes;
-  boxes.push_back(std::move(root));
-
-  while (static_cast<int>(boxes.size()) < n_colors) {
-    int best_idx = -1;
-    MedianCutStats best_stats{0, 0, 0, false};
-
-    for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
-      const auto stats = compute_box_stats(boxes[i], colors);
-      if (!stats.splittable) continue;
-      if (best_idx < 0 || stats.range > best_stats.range ||
-          (stats.range == best_stats.range &&
-           stats.population > best_stats.population)) {
-        best_idx = i;
-        best_stats = stats;
+  const auto hist = aznyan::color_histogram(bgr);
+
+  // The histogram cannot tell how many distinct colors share a cell, so
+  // count them exactly only when the image may already fit the palette.
+  const int occupied = static_cast<int>(
+      std::count_if(hist.begin(), hist.end(),
+                    [](const auto& cell) { return cell.count > 0; }));
+  if (occupied <= n_colors) {
+    std::vector<uint64_t> seen((1 << 24) / 64, 0);
+    int unique = 0;
+    for (int y = 0; y < height && unique <= n_colors; ++y) {
+      const cv::Vec3b* row = bgr.ptr<cv::Vec3b>(y);
+      for (int x = 0; x < width; ++x) {
+        const uint32_t packed =
+            row[x][0] | (row[x][1] << 8) | (row[x][2] << 16);
+        const uint64_t bit = uint64_t{1} << (packed & 63);
+        if (!(seen[packed >> 6] & bit)) {
+          seen[packed >> 6] |= bit;
+          unique++;
+        }
       }
     }
-
-    if (best_idx < 0) {
-      break;
+    if (unique <= n_colors) {
+      return aznyan::encode_nr(bgr, bgra[1]);
     }
-
-    MedianCutBox left, right;
-    if (!split_box(boxes[best_idx], colors, best_stats.channel, &left,
-                   &right)) {
-      break;
-    }
-
-    boxes[best_idx] = std::move(left);
-    boxes.push_back(std::move(right));
   }
 
-  std::unordered_map<uint32_t, cv::Vec3b> palette;
-  palette.reserve(colors.size());
-
-  for (const auto& box : boxes) {
-    long long sum_b = 0;
-    long long sum_g = 0;
-    long long sum_r = 0;
-    long long total = 0;
-
-    for (const int color_id : box.color_ids) {
-      const auto& color = colors[color_id];
-      sum_b += static_cast<long long>(color.b) * color.count;
-      sum_g += static_cast<long long>(color.g) * color.count;
-      sum_r += static_cast<long long>(color.r) * color.count;
-      total += color.count;
-    }
-
-    const cv::Vec3b representative(
-        static_cast<uchar>(std::llround(static_cast<double>(sum_b) / total)),
-        static_cast<uchar>(std::llround(static_cast<double>(sum_g) / total)),
-        static_cast<uchar>(std::llround(static_cast<double>(sum_r) / total)));
-
-    for (const int color_id : box.color_ids) {
-      const auto& color = colors[color_id];
-      palette.emplace(pack_rgb(color.b, color.g, color.r), representative);
-    }
-  }
+  const auto palette = aznyan::median_cut_palette(hist, n_colors);
 
-  cv::Mat out = bgr.clone();
+  cv::Mat out(bgr.size(), CV_8UC3);
   aznyan::parallel_for(0, height, [&](int y) {
     const cv::Vec3b* src_row = bgr.ptr<cv::Vec3b>(y);
     cv::Vec3b* dst_row = out.ptr<cv::Vec3b>(y);
     for (int x = 0; x < width; ++x) {
-      const cv::Vec3b& px = src_row[x];
-      dst_row[x] = palette.at(pack_rgb(px[0], px[1], px[2]));
+      const int idx = aznyan::color_cell(src_row[x]);
+      dst_row[x] = palette.colors[palette.index[idx]];
     }
   });
 
@@ -1,4 +1,6 @@
 #include "aznyan_types.h"
+#include <array>
+#include <cstring>
 #include <numeric>
 
 namespace {
@@ -24,6 +26,237 @@ inline float pixel_value(int mode, const cv::Vec3b& v, const uchar& a) {
   }
 }
 
+/**
+ * 8-bit sort key of a pixel. Modes are the same as for pixel_value(), so
+ * the image must already be in HLS for modes 4-6.
+ */
+inline uchar pixel_key(int mode, const cv::Vec3b& v) {
+  switch (mode) {
+    case 0:  // luma
+      return cv::saturate_cast<uchar>(gray_value(v) * 255.f);
+    case 1:  // B
+    case 4:  // H
+      return v[0];
+    case 2:  // G
+    case 5:  // L
+      return v[1];
+    default:  // R, S
+      return v[2];
+  }
+}
+
+// Runs shorter than this are insertion-sorted instead of counted.
+constexpr int kCountingSortMin = 48;
+
+/**
+ * Stable sort of `n` pixels by their 8-bit keys. `buf` is scratch space of
+ * at least `n` elements.
+ */
+void sort_run(int* px, uchar* key, int n, bool decreasing, int* buf) {
+  if (n < 2) return;
+  if (n < kCountingSortMin) {
+    for (int i = 1; i < n; ++i) {
+      const int p = px[i];
+      const uchar k = key[i];
+      int j = i;
+      if (decreasing) {
+        for (; j > 0 && key[j - 1] < k; --j) {
+          px[j] = px[j - 1];
+          key[j] = key[j - 1];
+        }
+      } else {
+        for (; j > 0 && key[j - 1] > k; --j) {
+          px[j] = px[j - 1];
+          key[j] = key[j - 1];
+        }
+      }
+      px[j] = p;
+      key[j] = k;
+    }
+    return;
+  }
+  std::array<int, 256> offset{};
+  for (int i = 0; i < n; ++i) offset[key[i]]++;
+  int sum = 0;
+  if (decreasing) {
+    for (int k = 255; k >= 0; --k) {
+      const int c = offset[k];
+      offset[k] = sum;
+      sum += c;
+    }
+  } else {
+    for (int k = 0; k < 256; ++k) {
+      const int c = offset[k];
+      offset[k] = sum;
+      sum += c;
+    }
+  }
+  for (int i = 0; i < n; ++i) buf[offset[key[i]]++] = px[i];
+  std::copy(buf, buf + n, px);
+}
+
+/**
+ * Calls `f(start, end)` for every run of nonzero values in `in[0, len)`
+ * that is at least `min_length` long. `end` is exclusive.
+ */
+template <typename F>
+void for_each_run(const uchar* in, int len, int min_length, F f) {
+  for (int start = 0; start < len;) {
+    if (!in[start]) {
+      ++start;
+      continue;
+    }
+    int end = start + 1;
+    while (end < len && in[end]) ++end;
+    if (end - start >= min_length) f(start, end);
+    start = end;
+  }
+}
+
+// 1 where pixel_value() is within [lower, upper], 0 elsewhere.
+cv::Mat pixel_mask(const cv::Mat& bgr, int mode, float lower, float upper) {
+  cv::Mat inside(bgr.size(), CV_8UC1);
+  aznyan::parallel_for(0, bgr.rows, [&](int y) {
+    const cv::Vec3b* pIN = bgr.ptr<cv::Vec3b>(y);
+    uchar* pIn = inside.ptr<uchar>(y);
+    for (int x = 0; x < bgr.cols; ++x) {
+      const float v = pixel_value(mode, pIN[x], 255);
+      pIn[x] = v >= lower && v <= upper;
+    }
+  });
+  return inside;
+}
+
+cv::Mat pixel_keys(const cv::Mat& bgr, int mode) {
+  cv::Mat keys(bgr.size(), CV_8UC1);
+  aznyan::parallel_for(0, bgr.rows, [&](int y) {
+    const cv::Vec3b* pIN = bgr.ptr<cv::Vec3b>(y);
+    uchar* pKey = keys.ptr<uchar>(y);
+    for (int x = 0; x < bgr.cols; ++x) {
+      pKey[x] = pixel_key(mode, pIN[x]);
+    }
+  });
+  return keys;
+}
+
+/**
+ * Sorts the `n` pixels of `out` starting at `first` and `step` apart.
+ * `px`, `key` and `buf` are scratch buffers of at least `n` elements.
+ */
+void sort_span(int* out, const uchar* keys, int first, int step, int n,
+               bool decreasing, int* px, uchar* key, int* buf) {
+  for (int i = 0; i < n; ++i) {
+    px[i] = out[first + i * step];
+    key[i] = keys[first + i * step];
+  }
+  sort_run(px, key, n, decreasing, buf);
+  for (int i = 0; i < n; ++i) {
+    out[first + i * step] = px[i];
+  }
+}
+
+/**
+ * Maps a float to an unsigned integer with the same ordering, or the
+ * reverse ordering when `Descending` is true.
+ */
+template <bool Descending>
+inline uint32_t float_key(float v) {
+  uint32_t u;
+  std::memcpy(&u, &v, sizeof(u));
+  u ^= (u >> 31) ? 0xFFFFFFFFu : 0x80000000u;
+  return Descending ? ~u : u;
+}
+
+template <bool Descending>
+inline uchar byte_key(uchar v) {
+  return Descending ? 255 - v : v;
+}
+
+/**
+ * Stable LSD radix argsort over 8-bit digits. Each pass counts digits per
+ * chunk of the input in parallel, and then every chunk scatters its own
+ * elements to the offsets reserved for it, so the passes stay stable.
+ * Passes where every key has the same digit are skipped. For 8-bit keys
+ * this is a single counting sort.
+ */
+template <typename Key>
+std::vector<int> radix_argsort(std::vector<Key> keys) {
+  const int n = static_cast<int>(keys.size());
+  const int nchunks = std::clamp(n / 65536, 1, cv::getNumThreads());
+  const int chunk = (n + nchunks - 1) / nchunks;
+
+  std::vector<int> idx(n), idx_tmp(n);
+  std::iota(idx.begin(), idx.end(), 0);
+  std::vector<Key> keys_tmp(n);
+  std::vector<std::array<int, 256>> offset(nchunks);
+
+  for (size_t pass = 0; pass < sizeof(Key); ++pass) {
+    const int shift = static_cast<int>(pass) * 8;
+    aznyan::parallel_for(0, nchunks, [&](int c) {
+      offset[c].fill(0);
+      const int ed = std::min(n, (c + 1) * chunk);
+      for (int i = c * chunk; i < ed; ++i) {
+        offset[c][(keys[i] >> shift) & 255]++;
+      }
+    });
+    bool trivial = false;
+    int sum = 0;
+    for (int d = 0; d < 256; ++d) {
+      const int before = sum;
+      for (int c = 0; c < nchunks; ++c) {
+        const int count = offset[c][d];
+        offset[c][d] = sum;
+        sum += count;
+      }
+      if (sum - before == n) trivial = true;
+    }
+    if (trivial) continue;
+    aznyan::parallel_for(0, nchunks, [&](int c) {
+      const int ed = std::min(n, (c + 1) * chunk);
+      for (int i = c * chunk; i < ed; ++i) {
+        const int at = offset[c][(keys[i] >> shift) & 255]++;
+        idx_tmp[at] = idx[i];
+        keys_tmp[at] = keys[i];
+      }
+    });
+    idx.swap(idx_tmp);
+    keys.swap(keys_tmp);
+  }
+  return idx;
+}
+
+/**
+ * Order of the pixels by pixel_value(). The properties that are 8-bit
+ * channels are counting-sorted on their bytes; luma and packed values
+ * are radix-sorted on their float bits.
+ */
+template <bool Descending>
+std::vector<int> sort_index(const cv::Mat& bgr, const cv::Mat& alpha,
+                            int mode) {
+  const int height = bgr.rows, width = bgr.cols;
+  if (mode >= 1 && mode <= 6) {
+    std::vector<uchar> keys(static_cast<size_t>(height) * width);
+    aznyan::parallel_for(0, height, [&](int y) {
+      const cv::Vec3b* pIN = bgr.ptr<cv::Vec3b>(y);
+      uchar* dst = &keys[static_cast<size_t>(y) * width];
+      for (int x = 0; x < width; ++x) {
+        dst[x] = byte_key<Descending>(pixel_key(mode, pIN[x]));
+      }
+    });
+    return radix_argsort(std::move(keys));
+  }
+  std::vector<uint32_t> keys(static_cast<size_t>(height) * width);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const cv::Vec3b* pIN1 = bgr.ptr<cv::Vec3b>(y);
+    const uchar* pIN2 = alpha.ptr<uchar>(y);
+    uint32_t* dst = &keys[static_cast<size_t>(y) * width];
+    for (int x = 0; x < width; ++x) {
+      dst[x] = float_key<Descending>(pixel_value(mode, pIN1[x], pIN2[x]));
+    }
+  });
+  return radix_argsort(std::move(keys));
+}
+
 }  // namespace
 
 [[cpp11::register]]
@@ -35,40 +268,45 @@ cpp11::list azny_pixel_positions(const cpp11::integers& nr, int height,
     cv::cvtColor(bgra[0], bgra[0], cv::COLOR_BGR2HLS);
   }
 
-  std::vector<std::vector<int>> row(height);  // outer
-  std::vector<std::vector<int>> col(height);  // inner
-  std::vector<std::vector<int>> idx(height);
-
+  // Count the matches of every row first, so that each row can then write
+  // its positions straight into the output at its own offset.
+  cv::Mat inside(height, width, CV_8UC1);
+  std::vector<R_xlen_t> offset(height + 1, 0);
   aznyan::parallel_for(0, height, [&](int y) {
     const cv::Vec3b* pIN1 = bgra[0].ptr<cv::Vec3b>(y);
-    // const uchar* pIN2 = bgra[1].ptr<uchar>(y);
-    std::vector<int> row_inner, col_inner, idx_inner;
-    float v;
+    uchar* pIn = inside.ptr<uchar>(y);
+    int count = 0;
     for (int x = 0; x < width; ++x) {
-      v = pixel_value(mode, pIN1[x], 255);
-      if (v >= lower && v <= upper) {
-        row_inner.push_back(y + 1);
-        col_inner.push_back(x + 1);
-        idx_inner.push_back(x + y * width + 1);
-      }
+      const float v = pixel_value(mode, pIN1[x], 255);
+      pIn[x] = v >= lower && v <= upper;
+      count += pIn[x];
+    }
+    offset[y + 1] = count;
+  });
+  std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+  cpp11::writable::integers row(offset[height]);  // outer
+  cpp11::writable::integers col(offset[height]);  // inner
+  cpp11::writable::integers idx(offset[height]);
+  int* prow = INTEGER(row);
+  int* pcol = INTEGER(col);
+  int* pidx = INTEGER(idx);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const uchar* pIn = inside.ptr<uchar>(y);
+    R_xlen_t at = offset[y];
+    for (int x = 0; x < width; ++x) {
+      if (!pIn[x]) continue;
+      prow[at] = y + 1;
+      pcol[at] = x + 1;
+      pidx[at] = x + y * width + 1;
+      ++at;
     }
-    row[y] = row_inner;
-    col[y] = col_inner;
-    idx[y] = idx_inner;
   });
 
-  std::vector<int> row_out;
-  std::vector<int> col_out;
-  std::vector<int> idx_out;
-  for (std::size_t i = 0; i < row.size(); ++i) {
-    row_out.insert(row_out.end(), row[i].begin(), row[i].end());
-    col_out.insert(col_out.end(), col[i].begin(), col[i].end());
-    idx_out.insert(idx_out.end(), idx[i].begin(), idx[i].end());
-  }
   cpp11::writable::list out;
-  out.push_back(cpp11::as_sexp(row_out));
-  out.push_back(cpp11::as_sexp(col_out));
-  out.push_back(cpp11::as_sexp(idx_out));
+  out.push_back(row);
+  out.push_back(col);
+  out.push_back(idx);
 
   return out;
 }
@@ -81,23 +319,172 @@ cpp11::integers azny_sort_index(const cpp11::integers& nr, int height,
   if (mode >= 4) {
     cv::cvtColor(bgra[0], bgra[0], cv::COLOR_BGR2HLS);
   }
-  const bool dc = decending[0];
-  std::vector<float> ret(height * width);
+  const std::vector<int> idx =
+      decending[0] ? sort_index<true>(bgra[0], bgra[1], mode)
+                   : sort_index<false>(bgra[0], bgra[1], mode);
+  return cpp11::as_sexp(idx);
+}
 
-  aznyan::parallel_for(0, height, [&](int y) {
-    const cv::Vec3b* pIN1 = bgra[0].ptr<cv::Vec3b>(y);
-    const uchar* pIN2 = bgra[1].ptr<uchar>(y);
-    for (int x = 0; x < width; ++x) {
-      ret[y * width + x] = pixel_value(mode, pIN1[x], pIN2[x]);
+/**
+ * Pixel sorting. Each row (or column) is split into intervals of
+ * consecutive pixels whose value is within [lower, upper], and every
+ * interval of at least `min_length` pixels is sorted by its 8-bit key.
+ * Lines are independent, so they are processed in parallel.
+ */
+[[cpp11::register]]
+cpp11::integers azny_pixel_sort(const cpp11::integers& nr, int height,
+                                int width, int mode, float lower, float upper,
+                                bool vertical, int min_length,
+                                bool decreasing) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  if (mode >= 4) {
+    cv::cvtColor(bgra[0], bgra[0], cv::COLOR_BGR2HLS);
+  }
+  const cv::Mat keys = pixel_keys(bgra[0], mode);
+  const cv::Mat inside = pixel_mask(bgra[0], mode, lower, upper);
+
+  std::vector<int> out(nr.begin(), nr.end());
+  const int lines = vertical ? width : height;
+  const int len = vertical ? height : width;
+  // Offset between consecutive pixels of a line, and between lines.
+  const int step = vertical ? width : 1;
+  const int stride = vertical ? 1 : width;
+
+  aznyan::parallel_for(0, lines, [&](int l) {
+    std::vector<int> px(len), buf(len);
+    std::vector<uchar> key(len), in(len);
+    const uchar* pIn = inside.ptr<uchar>();
+    for (int i = 0; i < len; ++i) {
+      in[i] = pIn[l * stride + i * step];
     }
+    for_each_run(in.data(), len, std::max(min_length, 2),
+                 [&](int start, int end) {
+                   sort_span(out.data(), keys.ptr<uchar>(),
+                             l * stride + start * step, step, end - start,
+                             decreasing, px.data(), key.data(), buf.data());
+                 });
   });
 
-  std::vector<int> idx(ret.size());
-  std::iota(idx.begin(), idx.end(), 0);
+  cpp11::writable::integers ret = cpp11::as_sexp(out);
+  ret.attr("dim") = cpp11::as_sexp({height, width});
+  return ret;
+}
 
-  std::sort(idx.begin(), idx.end(), [&ret, dc](int lhs, int rhs) {
-    return dc ? ret[lhs] > ret[rhs] : ret[lhs] < ret[rhs];
+/**
+ * Same as azny_pixel_sort(), but sorts the given runs instead of finding
+ * them. `group`, `start` and `end` are 1-based, and runs must not overlap.
+ */
+[[cpp11::register]]
+cpp11::integers azny_pixel_sort_runs(const cpp11::integers& nr, int height,
+                                     int width, int mode, bool vertical,
+                                     bool decreasing,
+                                     const cpp11::integers& group,
+                                     const cpp11::integers& start,
+                                     const cpp11::integers& end) {
+  const int lines = vertical ? width : height;
+  const int len = vertical ? height : width;
+  const int nruns = static_cast<int>(group.size());
+  if (start.size() != nruns || end.size() != nruns) {
+    cpp11::stop("group, start and end must have the same length.");
+  }
+  const std::vector<int> g(group.begin(), group.end());
+  const std::vector<int> s(start.begin(), start.end());
+  const std::vector<int> e(end.begin(), end.end());
+  std::vector<int> order(nruns);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return g[a] != g[b] ? g[a] < g[b] : s[a] < s[b];
   });
+  // Where the runs of each line begin in `order`, so that every line sets
+  // up its scratch buffers once rather than once per run.
+  std::vector<int> line_at;
+  for (int i = 0; i < nruns; ++i) {
+    const int r = order[i];
+    if (g[r] < 1 || g[r] > lines || s[r] < 1 || e[r] < s[r] || e[r] > len) {
+      cpp11::stop("Runs must lie within the image.");
+    }
+    if (i > 0 && g[order[i - 1]] == g[r]) {
+      if (e[order[i - 1]] >= s[r]) cpp11::stop("Runs must not overlap.");
+    } else {
+      line_at.push_back(i);
+    }
+  }
+  line_at.push_back(nruns);
 
-  return cpp11::as_sexp(idx);
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  if (mode >= 4) {
+    cv::cvtColor(bgra[0], bgra[0], cv::COLOR_BGR2HLS);
+  }
+  const cv::Mat keys = pixel_keys(bgra[0], mode);
+
+  std::vector<int> out(nr.begin(), nr.end());
+  const int step = vertical ? width : 1;
+  const int stride = vertical ? 1 : width;
+
+  aznyan::parallel_for(0, static_cast<int>(line_at.size()) - 1, [&](int l) {
+    std::vector<int> px(len), buf(len);
+    std::vector<uchar> key(len);
+    for (int i = line_at[l]; i < line_at[l + 1]; ++i) {
+      const int r = order[i];
+      sort_span(out.data(), keys.ptr<uchar>(),
+                (g[r] - 1) * stride + (s[r] - 1) * step, step,
+                e[r] - s[r] + 1, decreasing, px.data(), key.data(),
+                buf.data());
+    }
+  });
+
+  cpp11::writable::integers ret = cpp11::as_sexp(out);
+  ret.attr("dim") = cpp11::as_sexp({height, width});
+  return ret;
+}
+
+/**
+ * Run-length encoded form of azny_pixel_positions(). Returns the line,
+ * first and last position (all 1-based) of every run of matching pixels
+ * along rows or columns that is at least `min_length` long.
+ */
+[[cpp11::register]]
+cpp11::list azny_pixel_runs(const cpp11::integers& nr, int height, int width,
+                            int mode, float lower, float upper, bool vertical,
+                            int min_length) {
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+  if (mode >= 4) {
+    cv::cvtColor(bgra[0], bgra[0], cv::COLOR_BGR2HLS);
+  }
+  cv::Mat inside = pixel_mask(bgra[0], mode, lower, upper);
+  if (vertical) cv::transpose(inside, inside);
+  const int lines = inside.rows, len = inside.cols;
+  min_length = std::max(min_length, 1);
+
+  std::vector<R_xlen_t> offset(lines + 1, 0);
+  aznyan::parallel_for(0, lines, [&](int l) {
+    int count = 0;
+    for_each_run(inside.ptr<uchar>(l), len, min_length,
+                 [&](int, int) { ++count; });
+    offset[l + 1] = count;
+  });
+  std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+  cpp11::writable::integers group(offset[lines]);
+  cpp11::writable::integers first(offset[lines]);
+  cpp11::writable::integers last(offset[lines]);
+  int* pgroup = INTEGER(group);
+  int* pfirst = INTEGER(first);
+  int* plast = INTEGER(last);
+  aznyan::parallel_for(0, lines, [&](int l) {
+    R_xlen_t at = offset[l];
+    for_each_run(inside.ptr<uchar>(l), len, min_length,
+                 [&](int start, int end) {
+                   pgroup[at] = l + 1;
+                   pfirst[at] = start + 1;
+                   plast[at] = end;
+                   ++at;
+                 });
+  });
+
+  cpp11::writable::list out;
+  out.push_back(group);
+  out.push_back(first);
+  out.push_back(last);
+  return out;
 }
@@ -0,0 +1,706 @@
+#include "aznyan_quantize.h"
+#include <queue>
+
+namespace {
+
+using aznyan::ColorCell;
+using aznyan::quant_bits;
+using aznyan::quant_cells;
+using aznyan::quant_side;
+
+/**
+ * Box of histogram cells, bounds inclusive and in channel order B, G, R.
+ * The stats used to rank boxes are computed once, when the box is made.
+ */
+struct MedianCutBox {
+  std::array<int, 3> lo;
+  std::array<int, 3> hi;
+  long long population;
+  int channel;
+  int range;
+  int order;
+};
+
+template <typename FUNC>
+void for_each_cell(const MedianCutBox& box, FUNC func) {
+  for (int r = box.lo[2]; r <= box.hi[2]; ++r) {
+    for (int g = box.lo[1]; g <= box.hi[1]; ++g) {
+      for (int b = box.lo[0]; b <= box.hi[0]; ++b) {
+        func(aznyan::color_cell(b, g, r), std::array<int, 3>{b, g, r});
+      }
+    }
+  }
+}
+
+// Shrinks `box` to its occupied cells and caches its stats.
+void shrink_box(MedianCutBox& box, const std::vector<ColorCell>& hist) {
+  std::array<int, 3> lo{quant_side, quant_side, quant_side};
+  std::array<int, 3> hi{-1, -1, -1};
+  long long population = 0;
+  for_each_cell(box, [&](int idx, const std::array<int, 3>& at) {
+    if (hist[idx].count == 0) return;
+    for (int c = 0; c < 3; ++c) {
+      lo[c] = std::min(lo[c], at[c]);
+      hi[c] = std::max(hi[c], at[c]);
+    }
+    population += hist[idx].count;
+  });
+  box.lo = lo;
+  box.hi = hi;
+  box.population = population;
+
+  int channel = 0;
+  if (hi[1] - lo[1] > hi[channel] - lo[channel]) channel = 1;
+  if (hi[2] - lo[2] > hi[channel] - lo[channel]) channel = 2;
+  box.channel = channel;
+  box.range = (hi[channel] - lo[channel]) << (8 - quant_bits);
+}
+
+// Splits at the weighted median of the box's widest channel.
+void split_box(const MedianCutBox& box, const std::vector<ColorCell>& hist,
+               MedianCutBox* left, MedianCutBox* right) {
+  const int channel = box.channel;
+  std::array<long long, quant_side> marginal{};
+  for_each_cell(box, [&](int idx, const std::array<int, 3>& at) {
+    marginal[at[channel]] += hist[idx].count;
+  });
+
+  const long long target = (box.population + 1) / 2;
+  long long cumulative = 0;
+  int split_at = box.lo[channel];
+  for (int v = box.lo[channel]; v < box.hi[channel]; ++v) {
+    cumulative += marginal[v];
+    split_at = v;
+    if (cumulative >= target) break;
+  }
+
+  *left = box;
+  *right = box;
+  left->hi[channel] = split_at;
+  right->lo[channel] = split_at + 1;
+  shrink_box(*left, hist);
+  shrink_box(*right, hist);
+}
+
+// Moment tables have one extra plane of zeros in front of every axis.
+constexpr int kWuSide = quant_side + 1;
+
+inline int wu_at(int r, int g, int b) {
+  return (r * kWuSide + g) * kWuSide + b;
+}
+
+struct WuMoments {
+  std::vector<double> wt, mr, mg, mb, m2;
+};
+
+// Boxes are half-open below: (r0, r1] x (g0, g1] x (b0, b1].
+struct WuBox {
+  int r0, r1, g0, g1, b0, b1;
+};
+
+double wu_volume(const WuBox& c, const std::vector<double>& m) {
+  return m[wu_at(c.r1, c.g1, c.b1)] - m[wu_at(c.r1, c.g1, c.b0)] -
+         m[wu_at(c.r1, c.g0, c.b1)] + m[wu_at(c.r1, c.g0, c.b0)] -
+         m[wu_at(c.r0, c.g1, c.b1)] + m[wu_at(c.r0, c.g1, c.b0)] +
+         m[wu_at(c.r0, c.g0, c.b1)] - m[wu_at(c.r0, c.g0, c.b0)];
+}
+
+// Part of the volume that does not depend on the cut position along `dir`.
+double wu_bottom(const WuBox& c, int dir, const std::vector<double>& m) {
+  switch (dir) {
+    case 2:  // R
+      return -m[wu_at(c.r0, c.g1, c.b1)] + m[wu_at(c.r0, c.g1, c.b0)] +
+             m[wu_at(c.r0, c.g0, c.b1)] - m[wu_at(c.r0, c.g0, c.b0)];
+    case 1:  // G
+      return -m[wu_at(c.r1, c.g0, c.b1)] + m[wu_at(c.r1, c.g0, c.b0)] +
+             m[wu_at(c.r0, c.g0, c.b1)] - m[wu_at(c.r0, c.g0, c.b0)];
+    default:  // B
+      return -m[wu_at(c.r1, c.g1, c.b0)] + m[wu_at(c.r1, c.g0, c.b0)] +
+             m[wu_at(c.r0, c.g1, c.b0)] - m[wu_at(c.r0, c.g0, c.b0)];
+  }
+}
+
+double wu_top(const WuBox& c, int dir, int pos, const std::vector<double>& m) {
+  switch (dir) {
+    case 2:
+      return m[wu_at(pos, c.g1, c.b1)] - m[wu_at(pos, c.g1, c.b0)] -
+             m[wu_at(pos, c.g0, c.b1)] + m[wu_at(pos, c.g0, c.b0)];
+    case 1:
+      return m[wu_at(c.r1, pos, c.b1)] - m[wu_at(c.r1, pos, c.b0)] -
+             m[wu_at(c.r0, pos, c.b1)] + m[wu_at(c.r0, pos, c.b0)];
+    default:
+      return m[wu_at(c.r1, c.g1, pos)] - m[wu_at(c.r1, c.g0, pos)] -
+             m[wu_at(c.r0, c.g1, pos)] + m[wu_at(c.r0, c.g0, pos)];
+  }
+}
+
+double wu_variance(const WuBox& c, const WuMoments& mom) {
+  const double dr = wu_volume(c, mom.mr);
+  const double dg = wu_volume(c, mom.mg);
+  const double db = wu_volume(c, mom.mb);
+  return wu_volume(c, mom.m2) -
+         (dr * dr + dg * dg + db * db) / wu_volume(c, mom.wt);
+}
+
+/**
+ * Finds the cut along `dir` that maximizes the between-box variance.
+ * Returns that variance term, and -1 in `cut` when no cut leaves both
+ * halves non-empty.
+ */
+double wu_maximize(const WuBox& c, int dir, int first, int last, int* cut,
+                   const std::array<double, 4>& whole, const WuMoments& mom) {
+  const double base_r = wu_bottom(c, dir, mom.mr);
+  const double base_g = wu_bottom(c, dir, mom.mg);
+  const double base_b = wu_bottom(c, dir, mom.mb);
+  const double base_w = wu_bottom(c, dir, mom.wt);
+  double best = 0.0;
+  *cut = -1;
+  for (int i = first; i < last; ++i) {
+    double half_r = base_r + wu_top(c, dir, i, mom.mr);
+    double half_g = base_g + wu_top(c, dir, i, mom.mg);
+    double half_b = base_b + wu_top(c, dir, i, mom.mb);
+    double half_w = base_w + wu_top(c, dir, i, mom.wt);
+    if (half_w == 0) continue;
+    double temp =
+        (half_r * half_r + half_g * half_g + half_b * half_b) / half_w;
+    half_r = whole[0] - half_r;
+    half_g = whole[1] - half_g;
+    half_b = whole[2] - half_b;
+    half_w = whole[3] - half_w;
+    if (half_w == 0) continue;
+    temp += (half_r * half_r + half_g * half_g + half_b * half_b) / half_w;
+    if (temp > best) {
+      best = temp;
+      *cut = i;
+    }
+  }
+  return best;
+}
+
+bool wu_cut(WuBox& set1, WuBox& set2, const WuMoments& mom) {
+  const std::array<double, 4> whole{
+      wu_volume(set1, mom.mr), wu_volume(set1, mom.mg),
+      wu_volume(set1, mom.mb), wu_volume(set1, mom.wt)};
+  int cut_r, cut_g, cut_b;
+  const double max_r =
+      wu_maximize(set1, 2, set1.r0 + 1, set1.r1, &cut_r, whole, mom);
+  const double max_g =
+      wu_maximize(set1, 1, set1.g0 + 1, set1.g1, &cut_g, whole, mom);
+  const double max_b =
+      wu_maximize(set1, 0, set1.b0 + 1, set1.b1, &cut_b, whole, mom);
+
+  set2 = set1;
+  if (max_r >= max_g && max_r >= max_b) {
+    if (cut_r < 0) return false;
+    set2.r0 = set1.r1 = cut_r;
+  } else if (max_g >= max_r && max_g >= max_b) {
+    if (cut_g < 0) return false;
+    set2.g0 = set1.g1 = cut_g;
+  } else {
+    if (cut_b < 0) return false;
+    set2.b0 = set1.b1 = cut_b;
+  }
+  return true;
+}
+
+inline int wu_cells(const WuBox& c) {
+  return (c.r1 - c.r0) * (c.g1 - c.g0) * (c.b1 - c.b0);
+}
+
+constexpr int kOctreeDepth = 6;
+
+struct OctreeNode {
+  std::array<int, 8> children;
+  long long count;
+  long long sum_b;
+  long long sum_g;
+  long long sum_r;
+  int level;
+  bool leaf;
+};
+
+inline int octree_branch(const cv::Vec3b& c, int level) {
+  const int shift = 7 - level;
+  return (((c[2] >> shift) & 1) << 2) | (((c[1] >> shift) & 1) << 1) |
+         ((c[0] >> shift) & 1);
+}
+
+inline cv::Vec3b cell_mean(const ColorCell& cell) {
+  const double n = static_cast<double>(cell.count);
+  return cv::Vec3b(static_cast<uchar>(std::llround(cell.sum_b / n)),
+                   static_cast<uchar>(std::llround(cell.sum_g / n)),
+                   static_cast<uchar>(std::llround(cell.sum_r / n)));
+}
+
+std::vector<int> occupied_cells(const std::vector<ColorCell>& hist) {
+  std::vector<int> cells;
+  for (int idx = 0; idx < quant_cells; ++idx) {
+    if (hist[idx].count > 0) cells.push_back(idx);
+  }
+  return cells;
+}
+
+}  // namespace
+
+namespace aznyan {
+
+std::vector<ColorCell> color_histogram(const cv::Mat& bgr) {
+  const int height = bgr.rows, width = bgr.cols;
+
+  // Per-band histograms, merged afterwards, so no locking is needed.
+  const int nbands = std::clamp(cv::getNumThreads(), 1, std::max(height, 1));
+  std::vector<std::vector<ColorCell>> partial(
+      nbands, std::vector<ColorCell>(quant_cells, ColorCell{0, 0, 0, 0, 0}));
+  parallel_for(0, nbands, [&](int band) {
+    auto& hist = partial[band];
+    const int y0 =
+        static_cast<int>(static_cast<long long>(height) * band / nbands);
+    const int y1 =
+        static_cast<int>(static_cast<long long>(height) * (band + 1) / nbands);
+    for (int y = y0; y < y1; ++y) {
+      const cv::Vec3b* row = bgr.ptr<cv::Vec3b>(y);
+      for (int x = 0; x < width; ++x) {
+        const cv::Vec3b& px = row[x];
+        auto& cell = hist[color_cell(px)];
+        cell.count++;
+        cell.sum_b += px[0];
+        cell.sum_g += px[1];
+        cell.sum_r += px[2];
+        cell.sum_sq += px[0] * px[0] + px[1] * px[1] + px[2] * px[2];
+      }
+    }
+  });
+  std::vector<ColorCell> hist = std::move(partial[0]);
+  parallel_for(0, quant_side, [&](int r) {
+    const int plane = quant_side * quant_side;
+    for (int idx = r * plane; idx < (r + 1) * plane; ++idx) {
+      for (int band = 1; band < nbands; ++band) {
+        const auto& cell = partial[band][idx];
+        hist[idx].count += cell.count;
+        hist[idx].sum_b += cell.sum_b;
+        hist[idx].sum_g += cell.sum_g;
+        hist[idx].sum_r += cell.sum_r;
+        hist[idx].sum_sq += cell.sum_sq;
+      }
+    }
+  });
+  return hist;
+}
+
+CellPalette median_cut_palette(const std::vector<ColorCell>& hist,
+                               int n_colors) {
+  auto lower = [](const MedianCutBox& a, const MedianCutBox& b) {
+    if (a.range != b.range) return a.range < b.range;
+    if (a.population != b.population) return a.population < b.population;
+    return a.order > b.order;
+  };
+  std::priority_queue<MedianCutBox, std::vector<MedianCutBox>,
+                      decltype(lower)>
+      queue(lower);
+  std::vector<MedianCutBox> boxes;
+
+  MedianCutBox root{{0, 0, 0},
+                    {quant_side - 1, quant_side - 1, quant_side - 1},
+                    0,
+                    0,
+                    0,
+                    0};
+  shrink_box(root, hist);
+  queue.push(root);
+  int order = 1;
+  while (!queue.empty() &&
+         static_cast<int>(queue.size() + boxes.size()) < n_colors) {
+    const MedianCutBox box = queue.top();
+    queue.pop();
+    if (box.range == 0) {
+      boxes.push_back(box);
+      continue;
+    }
+    MedianCutBox left, right;
+    split_box(box, hist, &left, &right);
+    left.order = order++;
+    right.order = order++;
+    queue.push(left);
+    queue.push(right);
+  }
+  for (; !queue.empty(); queue.pop()) {
+    boxes.push_back(queue.top());
+  }
+
+  CellPalette out{std::vector<cv::Vec3b>(boxes.size()),
+                  std::vector<int>(quant_cells, 0)};
+  parallel_for(0, static_cast<int>(boxes.size()), [&](int i) {
+    ColorCell acc{0, 0, 0, 0, 0};
+    for_each_cell(boxes[i], [&](int idx, const std::array<int, 3>&) {
+      acc.count += hist[idx].count;
+      acc.sum_b += hist[idx].sum_b;
+      acc.sum_g += hist[idx].sum_g;
+      acc.sum_r += hist[idx].sum_r;
+      out.index[idx] = i;
+    });
+    out.colors[i] = cell_mean(acc);
+  });
+  return out;
+}
+
+CellPalette wu_palette(const std::vector<ColorCell>& hist, int n_colors) {
+  WuMoments mom;
+  for (auto* m : {&mom.wt, &mom.mr, &mom.mg, &mom.mb, &mom.m2}) {
+    m->assign(kWuSide * kWuSide * kWuSide, 0.0);
+  }
+  for (int r = 0; r < quant_side; ++r) {
+    for (int g = 0; g < quant_side; ++g) {
+      for (int b = 0; b < quant_side; ++b) {
+        const auto& cell = hist[color_cell(b, g, r)];
+        const int at = wu_at(r + 1, g + 1, b + 1);
+        mom.wt[at] = static_cast<double>(cell.count);
+        mom.mr[at] = static_cast<double>(cell.sum_r);
+        mom.mg[at] = static_cast<double>(cell.sum_g);
+        mom.mb[at] = static_cast<double>(cell.sum_b);
+        mom.m2[at] = static_cast<double>(cell.sum_sq);
+      }
+    }
+  }
+  // Cumulative moments, so any box sum takes eight lookups.
+  for (auto* m : {&mom.wt, &mom.mr, &mom.mg, &mom.mb, &mom.m2}) {
+    auto& v = *m;
+    for (int r = 1; r < kWuSide; ++r) {
+      std::array<double, kWuSide> area{};
+      for (int g = 1; g < kWuSide; ++g) {
+        double line = 0.0;
+        for (int b = 1; b < kWuSide; ++b) {
+          line += v[wu_at(r, g, b)];
+          area[b] += line;
+          v[wu_at(r, g, b)] = v[wu_at(r - 1, g, b)] + area[b];
+        }
+      }
+    }
+  }
+
+  std::vector<WuBox> cubes(std::max(n_colors, 1));
+  std::vector<double> vv(cubes.size(), 0.0);
+  cubes[0] = WuBox{0, quant_side, 0, quant_side, 0, quant_side};
+  int count = 1;
+  int next = 0;
+  for (int i = 1; i < n_colors; ++i) {
+    if (wu_cut(cubes[next], cubes[i], mom)) {
+      vv[next] =
+          wu_cells(cubes[next]) > 1 ? wu_variance(cubes[next], mom) : 0.0;
+      vv[i] = wu_cells(cubes[i]) > 1 ? wu_variance(cubes[i], mom) : 0.0;
+      count = i + 1;
+    } else {
+      vv[next] = 0.0;
+      --i;
+    }
+    next = 0;
+    double temp = vv[0];
+    for (int k = 1; k <= i; ++k) {
+      if (vv[k] > temp) {
+        temp = vv[k];
+        next = k;
+      }
+    }
+    if (temp <= 0.0) break;
+  }
+
+  CellPalette out{std::vector<cv::Vec3b>(), std::vector<int>(quant_cells, 0)};
+  for (int k = 0; k < count; ++k) {
+    const WuBox& c = cubes[k];
+    const double w = wu_volume(c, mom.wt);
+    if (w <= 0) continue;
+    const int id = static_cast<int>(out.colors.size());
+    out.colors.emplace_back(
+        static_cast<uchar>(std::llround(wu_volume(c, mom.mb) / w)),
+        static_cast<uchar>(std::llround(wu_volume(c, mom.mg) / w)),
+        static_cast<uchar>(std::llround(wu_volume(c, mom.mr) / w)));
+    for (int r = c.r0; r < c.r1; ++r) {
+      for (int g = c.g0; g < c.g1; ++g) {
+        for (int b = c.b0; b < c.b1; ++b) {
+          out.index[color_cell(b, g, r)] = id;
+        }
+      }
+    }
+  }
+  return out;
+}
+
+CellPalette octree_palette(const std::vector<ColorCell>& hist, int n_colors) {
+  const OctreeNode empty{{-1, -1, -1, -1, -1, -1, -1, -1}, 0, 0, 0, 0, 0,
+                         false};
+  std::vector<OctreeNode> nodes{empty};
+  std::array<std::vector<int>, kOctreeDepth> reducible;
+  reducible[0].push_back(0);
+  int leaves = 0;
+
+  // Cells are inserted by their mean color, weighted by their population.
+  const std::vector<int> cells = occupied_cells(hist);
+  for (const int idx : cells) {
+    const auto& cell = hist[idx];
+    const cv::Vec3b mean = cell_mean(cell);
+    int node = 0;
+    for (int level = 0; level < kOctreeDepth; ++level) {
+      const int branch = octree_branch(mean, level);
+      int child = nodes[node].children[branch];
+      if (child < 0) {
+        child = static_cast<int>(nodes.size());
+        OctreeNode made = empty;
+        made.level = level + 1;
+        made.leaf = (level + 1 == kOctreeDepth);
+        nodes.push_back(made);
+        nodes[node].children[branch] = child;
+        if (made.leaf) {
+          leaves++;
+        } else {
+          reducible[level + 1].push_back(child);
+        }
+      }
+      node = child;
+    }
+    nodes[node].count += cell.count;
+    nodes[node].sum_b += cell.sum_b;
+    nodes[node].sum_g += cell.sum_g;
+    nodes[node].sum_r += cell.sum_r;
+  }
+
+  // Merge the least populated node of the deepest level into one leaf
+  // until the palette fits.
+  auto subtree_count = [&](int node) {
+    long long total = nodes[node].count;
+    for (const int child : nodes[node].children) {
+      if (child >= 0) total += nodes[child].count;
+    }
+    return total;
+  };
+  for (int level = kOctreeDepth - 1; level >= 0 && leaves > n_colors;) {
+    auto& list = reducible[level];
+    if (list.empty()) {
+      --level;
+      continue;
+    }
+    auto it = std::min_element(list.begin(), list.end(), [&](int a, int b) {
+      return subtree_count(a) < subtree_count(b);
+    });
+    const int node = *it;
+    *it = list.back();
+    list.pop_back();
+
+    int merged = 0;
+    for (int& child : nodes[node].children) {
+      if (child < 0) continue;
+      nodes[node].count += nodes[child].count;
+      nodes[node].sum_b += nodes[child].sum_b;
+      nodes[node].sum_g += nodes[child].sum_g;
+      nodes[node].sum_r += nodes[child].sum_r;
+      child = -1;
+      merged++;
+    }
+    nodes[node].leaf = true;
+    leaves -= merged - 1;
+  }
+
+  CellPalette out{std::vector<cv::Vec3b>(), std::vector<int>(quant_cells, 0)};
+  std::vector<int> leaf_id(nodes.size(), -1);
+  for (const int idx : cells) {
+    const cv::Vec3b mean = cell_mean(hist[idx]);
+    int node = 0;
+    while (!nodes[node].leaf) {
+      node = nodes[node].children[octree_branch(mean, nodes[node].level)];
+    }
+    if (leaf_id[node] < 0) {
+      leaf_id[node] = static_cast<int>(out.colors.size());
+      const auto& n = nodes[node];
+      out.colors.push_back(
+          cell_mean(ColorCell{n.count, n.sum_b, n.sum_g, n.sum_r, 0}));
+    }
+    out.index[idx] = leaf_id[node];
+  }
+  return out;
+}
+
+InverseColormap::InverseColormap(const std::vector<cv::Vec3b>& palette)
+    : palette_(palette), offsets_(quant_cells + 1, 0) {
+  if (palette_.empty()) {
+    cpp11::stop("Palette must have at least one color.");
+  }
+  constexpr int step = 1 << (8 - quant_bits);
+  const int n = static_cast<int>(palette_.size());
+  std::vector<std::vector<int>> lists(quant_cells);
+  parallel_for(0, quant_cells, [&](int cell) {
+    const int lo[3] = {(cell & (quant_side - 1)) * step,
+                       ((cell >> quant_bits) & (quant_side - 1)) * step,
+                       (cell >> (2 * quant_bits)) * step};
+    std::vector<int> near(n), far(n);
+    int bound = std::numeric_limits<int>::max();
+    for (int i = 0; i < n; ++i) {
+      int dn = 0, df = 0;
+      for (int c = 0; c < 3; ++c) {
+        const int v = palette_[i][c];
+        const int hi = lo[c] + step - 1;
+        const int below = std::max({lo[c] - v, v - hi, 0});
+        const int above = std::max(std::abs(v - lo[c]), std::abs(v - hi));
+        dn += below * below;
+        df += above * above;
+      }
+      near[i] = dn;
+      far[i] = df;
+      bound = std::min(bound, df);
+    }
+    for (int i = 0; i < n; ++i) {
+      if (near[i] <= bound) lists[cell].push_back(i);
+    }
+  });
+  for (int cell = 0; cell < quant_cells; ++cell) {
+    offsets_[cell + 1] =
+        offsets_[cell] + static_cast<int>(lists[cell].size());
+  }
+  candidates_.reserve(offsets_[quant_cells]);
+  for (const auto& list : lists) {
+    candidates_.insert(candidates_.end(), list.begin(), list.end());
+  }
+}
+
+void kmeans_refine(const std::vector<ColorCell>& hist, CellPalette& palette,
+                   int iterations) {
+  // Lloyd iterations over the occupied cells, weighted by population,
+  // rather than over every pixel.
+  const std::vector<int> cells = occupied_cells(hist);
+  const int ncells = static_cast<int>(cells.size());
+  std::vector<cv::Vec3f> means(ncells);
+  for (int i = 0; i < ncells; ++i) {
+    const auto& cell = hist[cells[i]];
+    const float n = static_cast<float>(cell.count);
+    means[i] = cv::Vec3f(cell.sum_b / n, cell.sum_g / n, cell.sum_r / n);
+  }
+
+  const int k = static_cast<int>(palette.colors.size());
+  std::vector<int> assign(ncells, 0);
+  for (int iter = 0; iter < iterations; ++iter) {
+    const PaletteSoA soa(palette.colors);
+    parallel_for(0, ncells, [&](int i) {
+      assign[i] = soa.nearest(means[i][0], means[i][1], means[i][2]);
+    });
+
+    std::vector<ColorCell> acc(k, ColorCell{0, 0, 0, 0, 0});
+    for (int i = 0; i < ncells; ++i) {
+      const auto& cell = hist[cells[i]];
+      auto& a = acc[assign[i]];
+      a.count += cell.count;
+      a.sum_b += cell.sum_b;
+      a.sum_g += cell.sum_g;
+      a.sum_r += cell.sum_r;
+    }
+    bool moved = false;
+    for (int j = 0; j < k; ++j) {
+      if (acc[j].count == 0) continue;  // keep empty clusters where they are
+      const cv::Vec3b c = cell_mean(acc[j]);
+      moved = moved || c != palette.colors[j];
+      palette.colors[j] = c;
+    }
+    if (!moved) break;
+  }
+
+  const PaletteSoA soa(palette.colors);
+  parallel_for(0, ncells, [&](int i) {
+    palette.index[cells[i]] =
+        soa.nearest(means[i][0], means[i][1], means[i][2]);
+  });
+}
+
+}  // namespace aznyan
+
+namespace {
+
+aznyan::CellPalette build_palette(const std::vector<ColorCell>& hist,
+                                  int n_colors, int method, int iterations) {
+  aznyan::CellPalette palette;
+  switch (method) {
+    case 1:
+      palette = aznyan::octree_palette(hist, n_colors);
+      break;
+    case 2:
+      palette = aznyan::median_cut_palette(hist, n_colors);
+      break;
+    default:
+      palette = aznyan::wu_palette(hist, n_colors);
+      break;
+  }
+  if (iterations > 0) {
+    aznyan::kmeans_refine(hist, palette, iterations);
+  }
+  return palette;
+}
+
+}  // namespace
+
+[[cpp11::register]]
+cpp11::integers azny_quantize_palette(const cpp11::list& frames,
+                                      const cpp11::integers& heights,
+                                      const cpp11::integers& widths,
+                                      int n_colors, int method,
+                                      int iterations) {
+  if (n_colors < 1) {
+    cpp11::stop("`n_colors` must be at least 1.");
+  }
+  // Frames share one histogram, so they get one palette.
+  std::vector<ColorCell> hist;
+  for (R_xlen_t i = 0; i < frames.size(); ++i) {
+    auto [bgra, ch] =
+        aznyan::decode_nr(cpp11::integers(frames[i]), heights[i], widths[i]);
+    auto frame_hist = aznyan::color_histogram(bgra[0]);
+    if (hist.empty()) {
+      hist = std::move(frame_hist);
+      continue;
+    }
+    aznyan::parallel_for(0, quant_side, [&](int r) {
+      const int plane = quant_side * quant_side;
+      for (int idx = r * plane; idx < (r + 1) * plane; ++idx) {
+        hist[idx].count += frame_hist[idx].count;
+        hist[idx].sum_b += frame_hist[idx].sum_b;
+        hist[idx].sum_g += frame_hist[idx].sum_g;
+        hist[idx].sum_r += frame_hist[idx].sum_r;
+        hist[idx].sum_sq += frame_hist[idx].sum_sq;
+      }
+    });
+    cpp11::check_user_interrupt();
+  }
+  const auto palette = build_palette(hist, n_colors, method, iterations);
+
+  std::vector<uint32_t> out(palette.colors.size());
+  for (size_t i = 0; i < out.size(); ++i) {
+    const cv::Vec3b& c = palette.colors[i];
+    out[i] = aznyan::pack_into_int(c[2], c[1], c[0], 255);
+  }
+  return cpp11::as_sexp(out);
+}
+
+[[cpp11::register]]
+cpp11::list azny_quantize(const cpp11::list& frames,
+                          const cpp11::integers& heights,
+                          const cpp11::integers& widths,
+                          const cpp11::integers& palette) {
+  std::vector<cv::Vec3b> colors(palette.size());
+  for (R_xlen_t i = 0; i < palette.size(); ++i) {
+    const auto [r, g, b, a] = aznyan::int_to_rgba(palette[i]);
+    colors[i] = cv::Vec3b(b, g, r);
+  }
+  // Built once and shared by every frame.
+  const aznyan::InverseColormap lookup(colors);
+
+  cpp11::writable::list out;
+  for (R_xlen_t i = 0; i < frames.size(); ++i) {
+    const int height = heights[i], width = widths[i];
+    auto [bgra, ch] =
+        aznyan::decode_nr(cpp11::integers(frames[i]), height, width);
+    cv::Mat mapped(bgra[0].size(), CV_8UC3);
+    aznyan::parallel_for(0, height, [&](int y) {
+      const cv::Vec3b* src_row = bgra[0].ptr<cv::Vec3b>(y);
+      cv::Vec3b* dst_row = mapped.ptr<cv::Vec3b>(y);
+      for (int x = 0; x < width; ++x) {
+        dst_row[x] = colors[lookup(src_row[x])];
+      }
+    });
+    out.push_back(aznyan::encode_nr(mapped, bgra[1]));
+    cpp11::check_user_interrupt();
+  }
+  return out;
+}
@@ -15,6 +15,62 @@ inline uint8_t bit_reverse(const uint8_t& b) {
   return (b * 0x0202020202ULL & 0x010884422010ULL) % 1023;
 }
 
+/**
+ * Applies a threshold map to `bgr`. `threshold(y)` returns a functor that
+ * gives the threshold of column x in row y, so a tiled pattern can be
+ * indexed modulo its size instead of being expanded to full size.
+ *
+ * With `levels < 2`, the gray level is compared with the threshold plus
+ * `cutoff`, and `lift` or `bias` is added. Otherwise, every channel is
+ * ordered-dithered to `levels` evenly spaced values.
+ */
+template <typename ROW>
+cv::Mat apply_screen_tone(const cv::Mat& bgr, int cutoff, int lift, int bias,
+                          int levels, ROW threshold) {
+  const int height = bgr.rows, width = bgr.cols;
+  if (levels < 2) {
+    cv::Mat gray;
+    cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+    cv::Mat out(gray.size(), CV_8UC1);
+    aznyan::parallel_for(0, height, [&](int y) {
+      const uchar* pIN = gray.ptr<uchar>(y);
+      uchar* pOUT = out.ptr<uchar>(y);
+      const auto pMAP = threshold(y);
+      for (int x = 0; x < width; ++x) {
+        pOUT[x] = pIN[x] > (pMAP(x) + cutoff)
+                      ? cv::saturate_cast<uchar>(pIN[x] + lift)
+                      : cv::saturate_cast<uchar>(pIN[x] + bias);
+      }
+    });
+    cv::Mat ret;
+    cv::merge(std::vector<cv::Mat>{out, out, out}, ret);
+    return ret;
+  }
+
+  // Output for every (threshold, value) pair. Thresholds spread each value
+  // between its two nearest levels so that the average is preserved.
+  const double step = 255.0 / (levels - 1);
+  std::vector<uchar> table(256 * 256);
+  for (int t = 0; t < 256; ++t) {
+    const double offset = (t + 0.5) / 256.0;
+    for (int v = 0; v < 256; ++v) {
+      const int idx = std::min(static_cast<int>(v / step + offset), levels - 1);
+      table[t * 256 + v] = cv::saturate_cast<uchar>(idx * step);
+    }
+  }
+  cv::Mat out(bgr.size(), CV_8UC3);
+  aznyan::parallel_for(0, height, [&](int y) {
+    const cv::Vec3b* pIN = bgr.ptr<cv::Vec3b>(y);
+    cv::Vec3b* pOUT = out.ptr<cv::Vec3b>(y);
+    const auto pMAP = threshold(y);
+    for (int x = 0; x < width; ++x) {
+      const uchar* row = &table[std::clamp(pMAP(x), 0, 255) * 256];
+      pOUT[x] = cv::Vec3b(row[pIN[x][0]], row[pIN[x][1]], row[pIN[x][2]]);
+    }
+  });
+  return out;
+}
+
 }  // namespace
 
 [[cpp11::register]]
@@ -31,27 +87,43 @@ cpp11::integers_matrix<> bayer_mat(const uint8_t& n) {
 [[cpp11::register]]
 cpp11::integers azny_screen_tone(const cpp11::integers& nr, int height,
                                  int width, int cutoff, int lift, int bias,
-                                 const cpp11::integers& pattern) {
+                                 int levels, const cpp11::integers& pattern) {
   auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
   auto [bgra_pat, ch_pat] = aznyan::decode_nr(pattern, height, width);
 
-  cv::Mat gray, gray_pat;
-  cv::cvtColor(bgra[0], gray, cv::COLOR_BGR2GRAY);
+  cv::Mat gray_pat;
   cv::cvtColor(bgra_pat[0], gray_pat, cv::COLOR_BGR2GRAY);
-  cv::Mat out(gray.size(), CV_8UC1);
 
-  aznyan::parallel_for(0, height, [&](int y) {
-    uchar* pIN = gray.ptr<uchar>(y);
-    uchar* pMAP = gray_pat.ptr<uchar>(y);
-    for (int x = 0; x < width; ++x) {
-      out.at<uchar>(y, x) = pIN[x] > (pMAP[x] + cutoff)
-                                ? cv::saturate_cast<uchar>(pIN[x] + lift)
-                                : cv::saturate_cast<uchar>(pIN[x] + bias);
-    }
-  });
+  cv::Mat ret = apply_screen_tone(
+      bgra[0], cutoff, lift, bias, levels, [&](int y) {
+        const uchar* pMAP = gray_pat.ptr<uchar>(y);
+        return [pMAP](int x) { return static_cast<int>(pMAP[x]); };
+      });
+  return aznyan::encode_nr(ret, bgra[1]);
+}
 
-  cv::Mat ret;
-  cv::merge(std::vector<cv::Mat>{out, out, out}, ret);
+[[cpp11::register]]
+cpp11::integers azny_screen_tone_tiled(
+    const cpp11::integers& nr, int height, int width, int cutoff, int lift,
+    int bias, int levels, const cpp11::integers_matrix<>& pattern) {
+  const int tile_h = pattern.nrow(), tile_w = pattern.ncol();
+  if (tile_h < 1 || tile_w < 1) {
+    cpp11::stop("`pattern` must not be empty.");
+  }
+  auto [bgra, ch] = aznyan::decode_nr(nr, height, width);
+
+  // Row-major copy of the tile, so that a row of thresholds is contiguous.
+  std::vector<int> tile(tile_h * tile_w);
+  for (int i = 0; i < tile_h; ++i) {
+    for (int j = 0; j < tile_w; ++j) {
+      tile[i * tile_w + j] = pattern(i, j);
+    }
+  }
 
+  cv::Mat ret = apply_screen_tone(
+      bgra[0], cutoff, lift, bias, levels, [&](int y) {
+        const int* pMAP = &tile[(y % tile_h) * tile_w];
+        return [pMAP, tile_w](int x) { return pMAP[x % tile_w]; };
+      });
   return aznyan::encode_nr(ret, bgra[1]);
 }